@@ -0,0 +1,147 @@
+#pragma once
+
+#include "chrono.hpp"
+#include "Essentials.hpp"
+
+namespace lite
+{
+  // Queue of expensive but deferrable work, spread over frames so that it
+  //  doesn't cause frame spikes. Work is submitted as a step function which
+  //  does a slice of the work each call and returns true once done. Every
+  //  frame Run calls as many steps as fit in the frame's time budget.
+  //
+  //  Each job comes with an estimate of how long a step takes. The estimate
+  //  is corrected by the measured time of every step, and steps which are
+  //  expected to overrun the remaining budget wait for a later frame, while
+  //  cheaper work queued behind them goes ahead. At least one step runs per
+  //  frame so that a job estimated above the whole budget still finishes.
+  //
+  //  Work is submitted and run on the main thread.
+  class BudgetedWork : public LightSingleton<BudgetedWork>
+  {
+  public: // types
+
+    struct Statistics
+    {
+      // Milliseconds spent running steps in the last Run.
+      double   Milliseconds = 0;
+
+      // Steps run in the last Run.
+      uint32_t Steps = 0;
+
+      // Steps left for a later frame in the last Run because they didn't fit.
+      uint32_t Deferred = 0;
+    };
+
+  private: // types
+
+    struct Job
+    {
+      function<bool()> Step;
+      // Expected milliseconds per step.
+      double           Estimate;
+    };
+
+  private: // data
+
+    vector<Job> jobs;
+    Statistics  stats;
+
+    // Jobs submitted by steps during Run, queued once it is done.
+    vector<Job> submitted;
+    bool        running = false;
+
+  public: // data
+
+    // Milliseconds of work allowed per frame.
+    double BudgetMilliseconds;
+
+  public: // properties
+
+    // Number of jobs which haven't finished.
+    size_t PendingCount() const { return jobs.size() + submitted.size(); }
+
+    // Counters on the last Run.
+    const Statistics& Stats() const { return stats; }
+
+  public: // methods
+
+    explicit BudgetedWork(double budgetMilliseconds = 2.0) :
+      BudgetMilliseconds(budgetMilliseconds)
+    {}
+
+    // Runs queued steps, oldest job first, until the budget is spent.
+    //  Finished jobs are removed.
+    void Run()
+    {
+      stats = Statistics();
+      running = true;
+      high_resolution_timer frameTimer;
+
+      size_t kept = 0;
+      for (size_t i = 0; i < jobs.size(); ++i)
+      {
+        Job& job = jobs[i];
+        double remaining = BudgetMilliseconds - frameTimer.elapsed_milliseconds();
+
+        // Keep the job for a later frame if its step doesn't fit.
+        if (stats.Steps && job.Estimate > remaining)
+        {
+          ++stats.Deferred;
+          Keep(i, kept++);
+          continue;
+        }
+
+        high_resolution_timer stepTimer;
+        bool done = job.Step();
+        double measured = stepTimer.elapsed_milliseconds();
+        ++stats.Steps;
+
+        // Move the estimate toward what the step actually cost.
+        job.Estimate += (measured - job.Estimate) * 0.25;
+
+        if (!done)
+        {
+          Keep(i, kept++);
+        }
+      }
+      jobs.resize(kept);
+
+      running = false;
+      for (auto& job : submitted)
+      {
+        jobs.push_back(move(job));
+      }
+      submitted.clear();
+
+      stats.Milliseconds = frameTimer.elapsed_milliseconds();
+    }
+
+    // Queues work done one step per call; 'step' returns true once done.
+    //  'estimate' is the expected number of milliseconds per step.
+    void Submit(function<bool()> step, double estimate)
+    {
+      Job job = { move(step), estimate };
+      (running ? submitted : jobs).push_back(move(job));
+    }
+
+  private: // methods
+
+    // Moves an unfinished job down over the finished ones.
+    void Keep(size_t from, size_t to)
+    {
+      if (from != to)
+      {
+        jobs[to] = move(jobs[from]);
+      }
+    }
+  };
+
+  // Prints the statistics of the last run.
+  inline ostream& operator<<(ostream& os, const BudgetedWork::Statistics& stats)
+  {
+    return os <<
+      "Budgeted work: " << stats.Steps << " steps in " << stats.Milliseconds << " ms, " <<
+      stats.Deferred << " deferred";
+  }
+} // namespace lite
@@ -25,9 +25,33 @@ namespace lite
     //  RigidBody associated with this collider.
     GOId objectWithRigidBody;
 
+    // Transforms from this object's up to, but excluding, the rigid body's
+    //  object, with the version of each when the offset was last computed.
+    vector<pair<const Transform*, uint32_t>> offsetChain;
+
     // Pointer to the collision primitive.
     shared_ptr<Primitive> primitive;
 
+    // The owner's HierarchyVersion when the attachment was last resolved.
+    //  Until the owner or one of its parents changes the cached pointers
+    //  below stay valid.
+    uint32_t resolvedHierarchyVersion = 0;
+    bool     resolved = false;
+
+    // The rigid body this collider is attached to. (May be null)
+    RigidBody* rigidBody = nullptr;
+
+    // This object's Transform.
+    Transform* transform = nullptr;
+
+  public: // methods
+
+    // Makes room in physics for 'count' more collision primitives.
+    static void ReserveSystems(size_t count)
+    {
+      Physics::CurrentInstance()->ReservePrimitives(count);
+    }
+
   protected: // methods
 
     // Calls on Physics to create the collision primitive.
@@ -44,24 +68,76 @@ namespace lite
       primitive = Physics::CurrentInstance()->AddCollisionPrimitive<Primitive>();
     }
 
+    // Keeps this component's own primitive. As when copying, the rigid body
+    //  is found again on the next push.
+    CollisionComponent& operator=(const CollisionComponent& b)
+    {
+      resolved = false;
+      return *this;
+    }
+
     // Searches the object hierarchy upwards for the closest RigidBody.
     void Initialize() override
     {
-      UpdateOwningRigidBody();
+      ResolveAttachment();
     }
 
     // Pushes the offset transform from the rigid body 
     //  to the underlying collision primitive.
     void PushToSystems() override
     {
-      RigidBody* rigidBody = UpdateOwningRigidBody();
+      // Only search the hierarchy again if this object or one of its parents
+      //  changed since the last search;
+      //  otherwise only recompute the offset if a transform in between moved.
+      if (!resolved || resolvedHierarchyVersion != OwnerReference().HierarchyVersion())
+      {
+        ResolveAttachment();
+      }
+      else if (OffsetChanged())
+      {
+        UpdateOffset();
+      }
+    }
+
+  private: // methods
+
+    // Whether any transform between this object and the rigid body's object
+    //  changed since the offset was last computed.
+    bool OffsetChanged() const
+    {
+      for (auto& link : offsetChain)
+      {
+        if (link.first->Version() != link.second)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Finds the owning rigid body and the transforms leading up to it,
+    //  and computes the offset of the collision primitive.
+    void ResolveAttachment()
+    {
+      rigidBody = UpdateOwningRigidBody();
+      transform = &OwnerReference()[Transform_];
+
+      // Gather the transforms between this object and the rigid body's object.
+      offsetChain.clear();
       if (rigidBody)
       {
-        // Update the primitive's offset transform from the rigid body.
-        Transform& thisTfm = OwnerReference()[Transform_];
-        Transform& bodyTfm = rigidBody->OwnerReference()[Transform_];
-        primitive->OffsetFromBody = thisTfm.GetOffsetFromParent(bodyTfm);
+        for (GameObject* object = &OwnerReference(); object != rigidBody->Owner(); object = object->Parent())
+        {
+          offsetChain.emplace_back(&(*object)[Transform_], 0);
+        }
       }
+
+      UpdateOffset();
+
+      // Looking up the transforms may have added some, so
+      //  only save the version once everything is in place.
+      resolvedHierarchyVersion = OwnerReference().HierarchyVersion();
+      resolved = true;
     }
 
     // Searches upwards for the closest associated rigid body and attaches
@@ -76,24 +152,34 @@ namespace lite
         return nullptr;
       }
 
-      // Check for first initialization.
-      if (!objectWithRigidBody)
+      // Check for first initialization, or if the owning rigid body has changed.
+      if (!objectWithRigidBody || objectWithRigidBody != rigidBody->OwnerReference().Identifier())
       {
+        // Assign the body to the collision primitive.
         objectWithRigidBody = rigidBody->OwnerReference().Identifier();
         rigidBody->AttachToPrimitive(*primitive);
-        return rigidBody;
       }
 
-      // Check if the owning rigid body has changed.
-      if (objectWithRigidBody != rigidBody->OwnerReference().Identifier())
+      return rigidBody;
+    }
+
+    // Updates the primitive's offset transform from the rigid body.
+    void UpdateOffset()
+    {
+      for (auto& link : offsetChain)
       {
-        // Re-assign the body to the collision primitive.
-        rigidBody->AttachToPrimitive(*primitive);
-        return rigidBody;
+        link.second = link.first->Version();
       }
 
-      return rigidBody;
+      if (rigidBody)
+      {
+        Transform& bodyTfm = rigidBody->OwnerReference()[Transform_];
+        primitive->OffsetFromBody = RigidTransform(transform->GetOffsetFromParent(bodyTfm));
+      }
     }
+
+    // Lets Component see which callbacks are overridden.
+    friend class Component<T>;
   };
 
   // Supports collisions with an infinite plane. Transform data is ignored
@@ -110,6 +196,17 @@ namespace lite
     //  plane. Note the Transform position is ignored.
     const float& Offset() const { return primitive->Offset; }
     void Offset(float f) { primitive->Offset = f; }
+
+  public: // methods
+
+    // Keeps this component's own primitive and copies the plane into it.
+    PlaneCollision& operator=(const PlaneCollision& b)
+    {
+      CollisionComponent::operator=(b);
+      Direction(b.Direction());
+      Offset(b.Offset());
+      return *this;
+    }
   };
 
   // Bind PlaneCollision to reflection.
@@ -138,6 +235,16 @@ namespace lite
     const float& Radius() const { return radius; }
     void Radius(float f) { radius = f; }
 
+  public: // methods
+
+    // Keeps this component's own primitive.
+    SphereCollision& operator=(const SphereCollision& b)
+    {
+      CollisionComponent::operator=(b);
+      radius = b.radius;
+      return *this;
+    }
+
   private: // methods
 
     // Sends the true radius of the sphere to physics.
@@ -146,17 +253,20 @@ namespace lite
       CollisionComponent::PushToSystems();
 
       // Update the primitive's radius using the maximum of transform's scale.
-      Transform& tfm = OwnerReference()[Transform_];
-      primitive->Radius = max(tfm.LocalScale.x, max(tfm.LocalScale.y, tfm.LocalScale.z)) * radius;
+      const float3& scale = transform->GetLocalScale();
+      primitive->Radius = max(scale.x, max(scale.y, scale.z)) * radius;
 
       if (DebugDrawCollisions())
       {
-        auto pos = tfm.GetWorldMatrix().r[3];
+        auto pos = transform->GetWorldMatrix().r[3];
         float3 posf;
         XMStoreFloat3(&posf, pos);
         DrawSphere(posf, { primitive->Radius*2, primitive->Radius*2, primitive->Radius*2 });
       }
     }
+
+    // Lets Component see which callbacks are overridden.
+    friend class Component<SphereCollision>;
   };
 
   // Bind SphereCollision to reflection.
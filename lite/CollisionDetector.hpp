@@ -60,6 +60,12 @@ namespace lite
       generatorMap[bType][aType] = generator;
     }
 
+    // Whether a contact generator exists for the types of the two primitives.
+    bool CanCollide(const CollisionPrimitive& a, const CollisionPrimitive& b) const
+    {
+      return generatorMap[a.Type()][b.Type()] != nullptr;
+    }
+
     // Collides two arbritrary primitives, possibly generating new contacts.
     size_t Collide(const CollisionPrimitive& a, const CollisionPrimitive& b, CollisionData& data)
     {
@@ -4,6 +4,7 @@
 #include "Essentials.hpp"
 #include "float4x4.hpp"
 #include "PhysicsRigidBody.hpp"
+#include "RigidTransform.hpp"
 #include <unordered_map>
 
 namespace lite
@@ -23,8 +24,8 @@ namespace lite
 
   private: // data
     
-    Matrix        transform;
-    PrimitiveType type;
+    RigidTransform transform;
+    PrimitiveType  type;
 
   public: // data
 
@@ -32,7 +33,7 @@ namespace lite
     PhysicsRigidBody* Body = nullptr;
 
     // Transformational offset from the rigid body.
-    float4x4 OffsetFromBody;
+    RigidTransform OffsetFromBody;
 
   public: // properties
 
@@ -51,7 +52,8 @@ namespace lite
     // Calculates the true transform of this primitive.
     void CalculateInternals()
     {
-      transform = Body->Transform() * OffsetFromBody;
+      // Offset within the body first, then the body's transform.
+      transform = OffsetFromBody * Body->Transform();
     }
 
     // Returns an axis of the transform matrix. 
@@ -62,7 +64,7 @@ namespace lite
     }
 
     // Returns the final transform of the primitive.
-    const Matrix& GetTransform() const
+    const RigidTransform& GetTransform() const
     {
       return transform;
     }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ComponentForward.hpp"
+#include "ComponentPool.hpp"
+#include "ComponentType.hpp"
 #include "Essentials.hpp"
 #include "Reflection.hpp"
 
@@ -16,7 +18,7 @@ namespace lite
     virtual ~IComponent() {}
 
     // Creates a copy of this component.
-    virtual unique_ptr<IComponent> Clone() const = 0;
+    virtual ComponentHandle Clone() const = 0;
 
     // Returns the type info for this component (using typeid).
     virtual const TypeInfo& GetType() const = 0;
@@ -24,6 +26,13 @@ namespace lite
     // Sets whether the component is active and updating.
     virtual void SetActive(bool active) = 0;
 
+    // Returns the dense index of this component's type. (see ComponentTypes)
+    virtual uint32_t TypeIndex() const = 0;
+
+    // Copies the settings of a component of the same type into this one,
+    //  keeping this component's own system resources.
+    virtual void ResetFrom(const IComponent& source) = 0;
+
   protected: // methods
 
     // Called on SetActive(true).
@@ -87,10 +96,10 @@ namespace lite
     Component& operator=(const Component&) = delete;
 
     // Creates a copy of this component.
-    unique_ptr<IComponent> Clone() const override
+    ComponentHandle Clone() const override
     {
-      // Make a new component of type T.
-      return make_unique<T>(*static_cast<const T*>(this));
+      // Make a new component of type T in its pool.
+      return ComponentPool<T>::Instance().Create(*static_cast<const T*>(this));
     }
 
     // Returns the type info for this component (using typeid).
@@ -120,6 +129,49 @@ namespace lite
       isActive = active;
     }
 
+    // Returns the dense index of this component's type. (see ComponentTypes)
+    uint32_t TypeIndex() const override
+    {
+      return ComponentTypes::IndexOf<T>();
+    }
+
+    // Copies the settings of a component of the same type into this one,
+    //  keeping this component's own system resources. Uses T's copy
+    //  assignment, which component types must define for this purpose.
+    void ResetFrom(const IComponent& source) override
+    {
+      FatalIf(&source.GetType() != &TypeOf<T>(), "Resetting a " << TypeOf<T>().Name << " from a " << source.GetType().Name);
+      static_cast<T&>(*this) = static_cast<const T&>(source);
+    }
+
+    // Returns a bit per ComponentCallback (see ComponentTypes) which T
+    //  overrides. A member pointer &T::Update names Component<T> as its class
+    //  only when neither T nor a class between them declares Update. Since
+    //  overrides are usually private, types overriding a callback befriend
+    //  Component<T>.
+    static uint32_t OverriddenCallbacks()
+    {
+      typedef void (Component<T>::*Default)();
+      uint32_t callbacks = 0;
+      if (!is_same<decltype(&T::Update), Default>::value)
+      {
+        callbacks |= 1 << uint32_t(ComponentCallback::Update);
+      }
+      if (!is_same<decltype(&T::PushToSystems), Default>::value)
+      {
+        callbacks |= 1 << uint32_t(ComponentCallback::PushToSystems);
+      }
+      if (!is_same<decltype(&T::PullFromSystems), Default>::value)
+      {
+        callbacks |= 1 << uint32_t(ComponentCallback::PullFromSystems);
+      }
+      return callbacks;
+    }
+
+    // Prepares systems for 'count' more components of this type, called when
+    //  reserving room in the pool. Types creating system resources hide this.
+    static void ReserveSystems(size_t count) {}
+
     // Default ostream formatting: prints the type of the component.
     friend ostream& operator<<(ostream& os, const Component<T>& c)
     {
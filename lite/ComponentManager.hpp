@@ -5,37 +5,67 @@
 
 namespace lite
 {
-  // Maintains a map of creation functions for all component types.
+  // Maintains a map of creation functions for all component types, and owns
+  //  the pool in which all components of each type are stored.
   class ComponentManager : public Singleton < ComponentManager >
   {
   private: // data
 
-    unordered_map<string, function<unique_ptr<IComponent>()>> components;
+    unordered_map<string, function<ComponentHandle()>> components;
+    unordered_map<string, IComponentPool*>             pools;
 
   public: // methods
 
     // Creates a component by name.
-    unique_ptr<IComponent> Create(const string& name)
+    ComponentHandle Create(const string& name)
     {
       auto it = components.find(name);
       if (it == components.end())
       {
         Fatal("Failed to find create function for component " << name << "\nCurrently registered components:\n" << *this);
-        return nullptr;
+        return ComponentHandle();
       }
       return it->second();
     }
 
+    // Calls a function on every live component of a type, in the order they
+    //  are stored in memory. Signature of the function is void(T&).
+    template <class T, class Function>
+    void ForEach(Function fn)
+    {
+      Pool<T>().ForEach(fn);
+    }
+
+    // Returns the pool storing all components of a type.
+    template <class T>
+    ComponentPool<T>& Pool()
+    {
+      return ComponentPool<T>::Instance();
+    }
+
+    // Returns the pool storing all components of a type by name. (May return null)
+    IComponentPool* Pool(const string& name) const
+    {
+      auto it = pools.find(name);
+      return it == pools.end() ? nullptr : it->second;
+    }
+
     // Registers a component with the manager.
     template <class T>
     void Register(string name = TypeOf<T>().Name)
     {
-      // Make a generic 'create' function returning an IComponent pointer.
-      auto create = []() -> unique_ptr < IComponent >
+      // Make a generic 'create' function constructing the component in its pool.
+      auto create = []() -> ComponentHandle
       {
-        return make_unique<T>();
+        return ComponentPool<T>::Instance().Create();
       };
 
+      // Index the type now so lookups by name work before any is created,
+      //  and skip the per-frame callbacks it leaves as no-ops.
+      ComponentTypes::Instance().AddAlias(name, ComponentTypes::IndexOf<T>());
+      ComponentTypes::Instance().SetCallbacks(ComponentTypes::IndexOf<T>(), T::OverriddenCallbacks());
+
+      pools.emplace(name, &Pool<T>());
       components.emplace(move(name), move(create));
     }
 
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Essentials.hpp"
+
+namespace lite
+{
+  class IComponent;
+
+  // Interface to the pool holding all components of one type.
+  class IComponentPool
+  {
+  public: // methods
+
+    virtual ~IComponentPool() {}
+
+    // Destroys the component in a slot and frees the slot.
+    virtual void Destroy(uint32_t index) = 0;
+
+    // Makes room for 'count' more components, along with any system
+    //  resources they will create, so that creating them doesn't allocate.
+    virtual void Reserve(size_t count) = 0;
+
+    // Number of live components in the pool.
+    virtual size_t Size() const = 0;
+  };
+
+  // Owning handle to a component living in a ComponentPool. Destroying
+  //  the handle destroys the component and returns its slot to the pool.
+  class ComponentHandle
+  {
+  private: // data
+
+    IComponent*     component = nullptr;
+    uint32_t        index = 0;
+    IComponentPool* pool = nullptr;
+
+  public: // properties
+
+    // Slot of the component in its pool.
+    const uint32_t& Index() const { return index; }
+
+    // Pool the component lives in. (May be null)
+    IComponentPool* const& Pool() const { return pool; }
+
+  public: // methods
+
+    ComponentHandle() = default;
+
+    ComponentHandle(IComponent* component_, uint32_t index_, IComponentPool* pool_) :
+      component(component_),
+      index(index_),
+      pool(pool_)
+    {}
+
+    ComponentHandle(const ComponentHandle&) = delete;
+    ComponentHandle& operator=(const ComponentHandle&) = delete;
+
+    ComponentHandle(ComponentHandle&& b) :
+      component(b.component),
+      index(b.index),
+      pool(b.pool)
+    {
+      b.component = nullptr;
+      b.pool = nullptr;
+    }
+
+    ComponentHandle& operator=(ComponentHandle&& b)
+    {
+      if (this != &b)
+      {
+        Reset();
+        component = b.component;
+        index = b.index;
+        pool = b.pool;
+        b.component = nullptr;
+        b.pool = nullptr;
+      }
+      return *this;
+    }
+
+    ~ComponentHandle()
+    {
+      Reset();
+    }
+
+    IComponent* get() const { return component; }
+    IComponent& operator*() const { return *component; }
+    IComponent* operator->() const { return component; }
+    explicit operator bool() const { return component != nullptr; }
+
+    // Destroys the component, leaving the handle empty.
+    void Reset()
+    {
+      if (pool)
+      {
+        pool->Destroy(index);
+      }
+      component = nullptr;
+      pool = nullptr;
+    }
+  };
+
+  // Stores all components of one type in fixed-size blocks. Components never
+  //  move once created, so pointers to them stay valid, and iterating with
+  //  ForEach walks memory linearly instead of chasing pointers around the heap.
+  //  Freed slots are reused first to keep the live components packed.
+  template <class T>
+  class ComponentPool : public IComponentPool
+  {
+  private: // types
+
+    // Number of components per block.
+    static const size_t BlockSize = 256;
+
+    struct Block
+    {
+      typename aligned_storage<sizeof(T), alignment_of<T>::value>::type slots[BlockSize];
+      bool alive[BlockSize];
+    };
+
+  private: // data
+
+    vector<unique_ptr<Block>> blocks;
+    size_t                    count = 0;
+    vector<uint32_t>          freeSlots;
+
+  public: // methods
+
+    // Returns the pool for this component type. Pools are never destroyed so
+    //  objects held in other static singletons can still release into them.
+    static ComponentPool& Instance()
+    {
+      static ComponentPool* pool = new ComponentPool();
+      return *pool;
+    }
+
+    // Constructs a new component in a free slot.
+    template <class... Args>
+    ComponentHandle Create(Args&&... args)
+    {
+      // Take a freed slot, or start a new block if all are in use.
+      if (freeSlots.empty())
+      {
+        AddBlock();
+      }
+
+      uint32_t index = freeSlots.back();
+      freeSlots.pop_back();
+
+      Block& block = *blocks[index / BlockSize];
+      T* component = new (&block.slots[index % BlockSize]) T(forward<Args>(args)...);
+      block.alive[index % BlockSize] = true;
+      ++count;
+
+      return ComponentHandle(component, index, this);
+    }
+
+    // Destroys the component in a slot and frees the slot.
+    void Destroy(uint32_t index) override
+    {
+      Block& block = *blocks[index / BlockSize];
+      FatalIf(!block.alive[index % BlockSize], "Destroying a component which is already destroyed");
+
+      Get(block, index % BlockSize).~T();
+      block.alive[index % BlockSize] = false;
+      freeSlots.push_back(index);
+      --count;
+    }
+
+    // Calls a function on every live component in slot order.
+    //  Signature of the function is void(T&).
+    template <class Function>
+    void ForEach(Function fn)
+    {
+      for (size_t b = 0; b < blocks.size(); ++b)
+      {
+        Block& block = *blocks[b];
+        for (size_t i = 0; i < BlockSize; ++i)
+        {
+          if (block.alive[i])
+          {
+            fn(Get(block, i));
+          }
+        }
+      }
+    }
+
+    // Makes room for 'count' more components, along with any system
+    //  resources they will create. (see Component::ReserveSystems)
+    void Reserve(size_t count) override
+    {
+      while (freeSlots.size() < count)
+      {
+        AddBlock();
+      }
+      T::ReserveSystems(count);
+    }
+
+    // Number of live components in the pool.
+    size_t Size() const override
+    {
+      return count;
+    }
+
+    T& operator[](uint32_t index)
+    {
+      return Get(*blocks[index / BlockSize], index % BlockSize);
+    }
+
+  private: // methods
+
+    ComponentPool() = default;
+
+    // Adds a block and frees all of its slots.
+    void AddBlock()
+    {
+      blocks.push_back(make_unique<Block>());
+      memset(blocks.back()->alive, 0, sizeof(blocks.back()->alive));
+
+      // Push in reverse so the lowest slot is taken first.
+      uint32_t first = uint32_t((blocks.size() - 1) * BlockSize);
+      for (uint32_t i = BlockSize; i > 0; --i)
+      {
+        freeSlots.push_back(first + i - 1);
+      }
+    }
+
+    static T& Get(Block& block, size_t slot)
+    {
+      return *reinterpret_cast<T*>(&block.slots[slot]);
+    }
+  };
+} // namespace lite
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "Reflection.hpp"
+
+namespace lite
+{
+  // Per-frame component callbacks which types may leave as no-ops.
+  enum class ComponentCallback
+  {
+    Update,
+    PushToSystems,
+    PullFromSystems,
+    Count
+  };
+
+  // Assigns each component type a small dense index, used by GameObject to
+  //  find its components with a bitmask and a table instead of a search.
+  //  Type names are interned to the same index so lookups by name only
+  //  hash the string once.
+  class ComponentTypes : public Singleton<ComponentTypes>
+  {
+  public: // types
+
+    // Maximum number of component types; each gets a bit in a 64-bit mask.
+    static const uint32_t MaxTypes = 64;
+
+    // Index returned for names which don't belong to a component type.
+    static const uint32_t NoIndex = ~0U;
+
+  private: // data
+
+    unordered_map<string, uint32_t> indices;
+    uint32_t                        count = 0;
+
+    // For each callback, a bit per type index which is cleared if the type
+    //  only inherits Component's no-op. Types which were never registered
+    //  keep their bits, so they are always called.
+    uint64_t callbackMasks[size_t(ComponentCallback::Count)];
+
+  public: // properties
+
+    // Number of component types indexed so far.
+    const uint32_t& Count() const { return count; }
+
+  public: // methods
+
+    ComponentTypes()
+    {
+      for (auto& mask : callbackMasks)
+      {
+        mask = ~uint64_t(0);
+      }
+    }
+
+    // Returns a mask of the type indices which may implement a callback.
+    uint64_t CallbackMask(ComponentCallback callback) const
+    {
+      return callbackMasks[size_t(callback)];
+    }
+
+    // Sets which callbacks a type implements, as a bit per ComponentCallback.
+    //  Called once when the type is registered, before any frame runs.
+    void SetCallbacks(uint32_t index, uint32_t callbacks)
+    {
+      for (size_t i = 0; i < size_t(ComponentCallback::Count); ++i)
+      {
+        if (callbacks & (1 << i))
+        {
+          callbackMasks[i] |= uint64_t(1) << index;
+        }
+        else
+        {
+          callbackMasks[i] &= ~(uint64_t(1) << index);
+        }
+      }
+    }
+
+    // Returns the index of a component type, assigning the next one the
+    //  first time the type is seen.
+    template <class T>
+    static uint32_t IndexOf()
+    {
+      static uint32_t index = Instance().Add(TypeOf<T>().Name);
+      return index;
+    }
+
+    // Returns the index of a component type by name. (May return NoIndex)
+    uint32_t Index(const string& name) const
+    {
+      auto it = indices.find(name);
+      return it == indices.end() ? NoIndex : it->second;
+    }
+
+    // Makes another name refer to an already indexed component type.
+    void AddAlias(const string& name, uint32_t index)
+    {
+      indices.emplace(name, index);
+    }
+
+  private: // methods
+
+    // Assigns the next index to a type name.
+    uint32_t Add(const string& name)
+    {
+      auto it = indices.find(name);
+      if (it != indices.end())
+      {
+        return it->second;
+      }
+
+      FatalIf(count == MaxTypes, "Too many component types; at most 64 are supported");
+      indices.emplace(name, count);
+      return count++;
+    }
+  };
+} // namespace lite
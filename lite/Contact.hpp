@@ -27,11 +27,27 @@ namespace lite
       return Contacts.back();
     }
 
-    // Empties the array of contacts and clears all values.
+    // Empties the array of contacts and clears all values. The
+    //  array's memory is kept for the next simulation step.
     void Clear()
     {
-      *this = CollisionData();
+      Contacts.clear();
+      Friction = 0;
+      Restitution = 0;
+      Tolerance = 0;
     }
+
+    // Drops the least important contacts until no more than 'budget' remain.
+    //  Contacts are ranked by penetration plus the distance their bodies will
+    //  close over the next 'dt' seconds, so deep or fast impacts survive.
+    void EnforceBudget(size_t budget, float dt);
+
+    // Reduces the contacts generated for a single pair of primitives (all
+    //  contacts starting at index 'first') to at most 'maxContacts'. The
+    //  deepest contact is kept first, followed by the contacts furthest from
+    //  those already kept to preserve the spread of the contact manifold.
+    //  Returns the number of contacts remaining for the pair.
+    size_t ReducePairContacts(size_t first, size_t maxContacts);
   };
 
   // A contact represents two bodies in contact. Resolving a
@@ -73,6 +89,10 @@ namespace lite
     // The lateral friction coefficient at this contact.
     float Friction;
 
+    // Total impulse applied at this contact in world space
+    //  while resolving velocities.
+    Vector Impulse;
+
     // The depth of penetration at the contact point. If both bodies
     //  are specified, then the contact point should be midway
     //  between the interpenetrating points.
@@ -85,6 +105,11 @@ namespace lite
     // Normal restitution coefficient at this contact.
     float Restitution;
 
+    // Matrix converting world-space to contact-space. The contact basis is
+    //  orthonormal, so this is the transpose of ContactToWorld; it is cached
+    //  so the resolver never has to transpose or invert per iteration.
+    Matrix WorldToContact;
+
   public: // methods
 
     Contact()
@@ -242,6 +267,7 @@ namespace lite
 
       // Convert impulse to world coordinates
       Vector impulse = Matrix(ContactToWorld).Transform(impulseContact);
+      Impulse += impulse;
 
       // Split in the impulse into linear and rotational components
       Vector impulsiveTorque = RelativeContactPosition[0].Cross(impulse);
@@ -327,6 +353,22 @@ namespace lite
       CalculateDesiredDeltaVelocity(dt);
     }
 
+    // Returns how important it is to resolve this contact: the current penetration
+    //  plus the distance the bodies will close along the normal within 'dt' seconds.
+    float Importance(float dt) const
+    {
+      // The normal points from the second body towards the first, so the bodies
+      //  are closing when the first body's relative velocity opposes it.
+      Vector relativeVelocity = Body[0] ? Body[0]->Velocity() : Vector();
+      if (Body[1])
+      {
+        relativeVelocity -= Body[1]->Velocity();
+      }
+      float closingVelocity = -relativeVelocity.Dot(ContactNormal);
+
+      return Penetration + max(closingVelocity, 0.0f) * dt;
+    }
+
     // Updates the awake state of rigid bodies that are taking place in the 
     //  given contact. A body will be made awake if it is in contact with a
     //  body that is awake.
@@ -399,6 +441,7 @@ namespace lite
       // Make a matrix from the three vectors.
       ContactToWorld = Matrix();
       ContactToWorld = Matrix(ContactToWorld).SetComponents(ContactNormal, contactTangent[0], contactTangent[1]);
+      WorldToContact = ContactToWorld.Transpose();
     }
 
     // Calculates the impulse needed to resolve this contact, given that the contact
@@ -443,7 +486,7 @@ namespace lite
       }
 
       // Do a change of basis to convert into contact coordinates.
-      Matrix deltaVelocity = ContactToWorld.Transpose();
+      Matrix deltaVelocity = WorldToContact;
       deltaVelocity *= deltaVelWorld;
       deltaVelocity *= ContactToWorld;
 
@@ -536,14 +579,14 @@ namespace lite
       velocity += thisBody->Velocity();
 
       // Turn the velocity into contact-coordinates.
-      Vector contactVelocity = ContactToWorld.TransformTranspose(velocity);
+      Vector contactVelocity = WorldToContact.Transform(velocity);
 
       // Calculate the ammount of velocity that is due to forces without
       // reactions.
       Vector accVelocity = thisBody->LastFrameAcceleration() * dt;
 
       // Calculate the velocity in contact-coordinates.
-      accVelocity = ContactToWorld.TransformTranspose(accVelocity);
+      accVelocity = WorldToContact.Transform(accVelocity);
 
       // We ignore any component of acceleration in the contact normal
       // direction, we are only interested in planar acceleration
@@ -567,4 +610,63 @@ namespace lite
     }
 
   };
+
+  inline void CollisionData::EnforceBudget(size_t budget, float dt)
+  {
+    if (Contacts.size() <= budget) return;
+
+    // Partition the most important contacts to the front of the array.
+    nth_element(
+      Contacts.begin(), 
+      Contacts.begin() + budget, 
+      Contacts.end(),
+      [=](const Contact& a, const Contact& b) { return a.Importance(dt) > b.Importance(dt); });
+
+    // Drop everything past the budget.
+    Contacts.erase(Contacts.begin() + budget, Contacts.end());
+  }
+
+  inline size_t CollisionData::ReducePairContacts(size_t first, size_t maxContacts)
+  {
+    size_t count = Contacts.size() - first;
+    if (count <= maxContacts) return count;
+
+    Contact* pair = Contacts.data() + first;
+
+    // Move the deepest contact to the front.
+    auto deepest = max_element(pair, pair + count, [](const Contact& a, const Contact& b)
+    {
+      return a.Penetration < b.Penetration;
+    });
+    swap(*pair, *deepest);
+
+    // Repeatedly keep the contact whose closest kept contact is furthest away.
+    for (size_t kept = 1; kept < maxContacts; ++kept)
+    {
+      size_t furthest = kept;
+      float furthestDistance = -1;
+
+      for (size_t i = kept; i < count; ++i)
+      {
+        float closestDistance = numeric_limits<float>::max();
+        for (size_t k = 0; k < kept; ++k)
+        {
+          Vector offset = pair[i].ContactPoint - pair[k].ContactPoint;
+          closestDistance = min(closestDistance, offset.Dot(offset));
+        }
+
+        if (closestDistance > furthestDistance)
+        {
+          furthestDistance = closestDistance;
+          furthest = i;
+        }
+      }
+
+      swap(pair[kept], pair[furthest]);
+    }
+
+    // Drop the contacts which weren't kept.
+    Contacts.erase(Contacts.begin() + first + maxContacts, Contacts.end());
+    return maxContacts;
+  }
 } // namespace lite
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "chrono.hpp"
 #include "Contact.hpp"
 
 namespace lite
@@ -9,7 +10,9 @@ namespace lite
   private: // data
 
     size_t positionIterationsUsed = 0;
+    float  positionSolveTime = 0;
     size_t velocityIterationsUsed = 0;
+    float  velocitySolveTime = 0;
 
   public: // data
 
@@ -21,13 +24,32 @@ namespace lite
 
     size_t VelocityIterations = 0;
 
+  public: // properties
+
+    // Iterations spent resolving interpenetration during the last resolve.
+    const size_t& PositionIterationsUsed() const { return positionIterationsUsed; }
+
+    // Milliseconds spent preparing contacts and resolving interpenetration.
+    const float& PositionSolveTime() const { return positionSolveTime; }
+
+    // Iterations spent resolving velocities during the last resolve.
+    const size_t& VelocityIterationsUsed() const { return velocityIterationsUsed; }
+
+    // Milliseconds spent resolving velocities during the last resolve.
+    const float& VelocitySolveTime() const { return velocitySolveTime; }
+
   public: // methods
 
     void ResolveContacts(aligned_vector<Contact>& contacts, float dt)
     {
+      positionIterationsUsed = velocityIterationsUsed = 0;
+      positionSolveTime = velocitySolveTime = 0;
+
       // Make sure we have something to do.
       if (contacts.size() == 0) return;
 
+      high_resolution_timer timer;
+
       // Prepare the contacts for processing.
       for (auto& contact : contacts)
       {
@@ -36,9 +58,12 @@ namespace lite
 
       // Resolve the interpenetration problems with the contacts.
       AdjustPositions(contacts.data(), contacts.size(), dt);
+      positionSolveTime = float(timer.elapsed_milliseconds());
+      timer.start();
 
       // Resolve the velocity problems with the contacts.
       AdjustVelocities(contacts.data(), contacts.size(), dt);
+      velocitySolveTime = float(timer.elapsed_milliseconds());
     }
 
   private: // methods
@@ -150,7 +175,7 @@ namespace lite
                   // The sign of the change is negative if we're dealing
                   // with the second body in a contact.
                   contacts[i].ContactVelocity = contacts[i].ContactVelocity +
-                    contacts[i].ContactToWorld.TransformTranspose(deltaVel)
+                    contacts[i].WorldToContact.Transform(deltaVel)
                     * (b ? -1.0f : 1.0f);
                   contacts[i].CalculateDesiredDeltaVelocity(dt);
                 }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Essentials.hpp"
+
+namespace lite
+{
+  // A value shared between copies until one of them writes to it. Copying
+  //  only shares the value; the first write through Write() gives the writer
+  //  a private copy. Meant for data that instances of a prefab rarely change,
+  //  so that a large population of copies keeps a single instance of it.
+  //
+  //  Copies are not synchronized: a shared value must not be written to
+  //  from two threads at once.
+  template <class T>
+  class CopyOnWrite
+  {
+  private: // data
+
+    shared_ptr<T> value;
+
+  public: // properties
+
+    // Whether other copies still share the value.
+    bool IsShared() const { return !value.unique(); }
+
+  public: // methods
+
+    CopyOnWrite() :
+      value(make_shared<T>())
+    {}
+
+    explicit CopyOnWrite(T value_) :
+      value(make_shared<T>(move(value_)))
+    {}
+
+    // Read-only access to the (possibly shared) value.
+    const T& operator*() const { return *value; }
+    const T* operator->() const { return value.get(); }
+
+    // Shares the current value, e.g. with a frame drawn on another thread.
+    //  While the holder keeps it, Write() copies instead of changing it.
+    shared_ptr<const T> Share() const { return value; }
+
+    // Writable access to the value, copying it first if it is shared.
+    T& Write()
+    {
+      if (!value.unique())
+      {
+        value = make_shared<T>(*value);
+      }
+      return *value;
+    }
+  };
+} // namespace lite
@@ -5,6 +5,7 @@
 #include "Essentials.hpp"
 #include "Matrix.hpp"
 #include "ModelInstance.hpp"
+#include "RenderFrame.hpp"
 
 namespace lite
 {
@@ -54,12 +55,12 @@ namespace lite
       spheres.emplace_back(position, scale, color);
     }
 
-    void Update()
+    // Moves the spheres drawn this frame into a render frame.
+    void Flush(RenderFrame& frame)
     {
-      // Draw all spheres.
       for (auto& sphere : spheres)
       {
-        sphere.Draw();
+        frame.Add(sphere);
       }
 
       // Clear all data to prepare for the next frame.
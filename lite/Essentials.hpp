@@ -33,7 +33,10 @@ namespace lite // types
 
     ~LightSingleton()
     {
-      InstancePointer() = nullptr;
+      if (InstancePointer() == static_cast<T*>(this))
+      {
+        InstancePointer() = nullptr;
+      }
     }
 
     // Returns a pointer to the most recently created instance.
@@ -42,6 +45,13 @@ namespace lite // types
       return InstancePointer();
     }
 
+    // Makes an instance current, e.g. to go back to the one which was
+    //  current before a temporary instance was created. (May be null)
+    static void MakeCurrent(T* instance)
+    {
+      InstancePointer() = instance;
+    }
+
   private: // methods
 
     static T*& InstancePointer()
@@ -90,6 +100,19 @@ namespace lite // functions
     return (T*)((char*)p + (0 < offset ? alignment - offset : offset));
   }
 
+  // Makes room for 'count' more elements in a vector. Capacity at least
+  //  doubles when it grows, so reserving a few elements at a time stays
+  //  amortized constant instead of reallocating on every call.
+  template <class Vector>
+  inline void ReserveMore(Vector& v, size_t count)
+  {
+    size_t needed = v.size() + count;
+    if (needed > v.capacity())
+    {
+      v.reserve(max(needed, v.capacity() * 2));
+    }
+  }
+
   static const unsigned tabSize = 2;
 
   // Returns a tab count as a string.
@@ -28,6 +28,9 @@ namespace lite
     // Type of the field.
     const TypeInfo* const& Type = type;
 
+    // Whether the field can be set.
+    bool IsWritable() const { return setter != nullptr; }
+
   public: // methods
 
     FieldInfo() = delete;
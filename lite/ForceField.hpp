@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "PhysicsRigidBody.hpp"
+
+namespace lite
+{
+  // Base class for all force fields. A force field acts on every rigid body
+  //  in the physics world in a single pass, rather than each body invoking
+  //  its own actor functions.
+  class ForceField
+  {
+  public: // data
+
+    // Bodies are only affected when they share a layer with this mask.
+    uint32_t LayerMask = ~0U;
+
+  public: // methods
+
+    virtual ~ForceField() {}
+
+    // Applies the field's force to all given bodies.
+    virtual void Apply(const vector<shared_ptr<PhysicsRigidBody>>& bodies, float dt) = 0;
+
+    // Whether the field has run its course and can be removed from physics.
+    virtual bool IsFinished() const { return false; }
+
+  protected: // methods
+
+    // Whether the body is enabled, on one of the field's layers and can be moved.
+    bool Affects(const PhysicsRigidBody& body) const
+    {
+      return body.Enabled && (body.Layers & LayerMask) != 0 && body.HasFiniteMass();
+    }
+  };
+
+  // Adds a constant force to every body.
+  class GravityField : public ForceField
+  {
+  public: // data
+
+    // Force added to each body every step.
+    float3 Force = { 0, -9.8f, 0 };
+
+  public: // methods
+
+    void Apply(const vector<shared_ptr<PhysicsRigidBody>>& bodies, float dt) override
+    {
+      for (auto& body : bodies)
+      {
+        if (Affects(*body)) body->AddForce(Force);
+      }
+    }
+  };
+
+  // Slows bodies down with a force opposing their velocity.
+  class DragField : public ForceField
+  {
+  public: // data
+
+    // Drag proportional to speed.
+    float LinearDrag = 0.1f;
+
+    // Drag proportional to speed squared.
+    float QuadraticDrag = 0.0f;
+
+  public: // methods
+
+    void Apply(const vector<shared_ptr<PhysicsRigidBody>>& bodies, float dt) override
+    {
+      for (auto& body : bodies)
+      {
+        if (!Affects(*body)) continue;
+
+        Vector velocity = body->Velocity();
+        float speed = velocity.Length();
+        if (speed == 0) continue;
+
+        body->AddForce(velocity * -(LinearDrag + QuadraticDrag * speed));
+      }
+    }
+  };
+
+  // Pushes bodies inside an axis-aligned box towards the wind velocity.
+  class WindField : public ForceField
+  {
+  public: // data
+
+    // Minimum corner of the wind volume.
+    float3 Min = { -1, -1, -1 };
+
+    // Maximum corner of the wind volume.
+    float3 Max = { 1, 1, 1 };
+
+    // How strongly bodies are pulled towards the wind velocity.
+    float Strength = 1.0f;
+
+    // Velocity of the air inside the volume.
+    float3 WindVelocity = { 1, 0, 0 };
+
+  public: // methods
+
+    void Apply(const vector<shared_ptr<PhysicsRigidBody>>& bodies, float dt) override
+    {
+      Vector windVelocity = WindVelocity;
+
+      for (auto& body : bodies)
+      {
+        if (!Affects(*body)) continue;
+
+        // Skip bodies outside of the volume.
+        float3 p = body->Position();
+        if (p.x < Min.x || p.y < Min.y || p.z < Min.z ||
+            p.x > Max.x || p.y > Max.y || p.z > Max.z) continue;
+
+        body->AddForce((windVelocity - body->Velocity()) * Strength);
+      }
+    }
+  };
+
+  // Pushes bodies away from a point for a short time. The force falls off
+  //  linearly to zero at the edge of the radius.
+  class ExplosionField : public ForceField
+  {
+  private: // data
+
+    // Time the explosion has been active.
+    float elapsed = 0;
+
+  public: // data
+
+    // Center of the explosion in world space.
+    float3 Center = { 0, 0, 0 };
+
+    // Seconds the explosion pushes bodies for.
+    float Duration = 0.1f;
+
+    // Force applied to a body at the center of the explosion.
+    float Force = 1000.0f;
+
+    // Distance at which the explosion no longer has any effect.
+    float Radius = 5.0f;
+
+  public: // methods
+
+    void Apply(const vector<shared_ptr<PhysicsRigidBody>>& bodies, float dt) override
+    {
+      if (IsFinished()) return;
+      elapsed += dt;
+
+      Vector center = Center;
+      float radiusSquared = Radius * Radius;
+
+      for (auto& body : bodies)
+      {
+        if (!Affects(*body)) continue;
+
+        Vector offset = body->Position() - center;
+        float distanceSquared = offset.Dot(offset);
+        if (distanceSquared >= radiusSquared || distanceSquared == 0) continue;
+
+        float distance = sqrt(distanceSquared);
+        float falloff = 1.0f - distance / Radius;
+        body->AddForce(offset * (Force * falloff / distance));
+      }
+    }
+
+    bool IsFinished() const override
+    {
+      return elapsed >= Duration;
+    }
+  };
+} // namespace lite
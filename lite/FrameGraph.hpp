@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include "Essentials.hpp"
+#include "JobSystem.hpp"
+
+namespace lite
+{
+  // A per-frame graph of tasks which declare the resources they read and
+  //  write. A task waits for every task added before it that writes what it
+  //  reads, or that reads or writes what it writes; everything else may run
+  //  at the same time on the current JobSystem. Tasks pinned to the main
+  //  thread only run on the thread calling Execute, which helps with the
+  //  other tasks in between.
+  class FrameGraph
+  {
+  public: // types
+
+    // Which threads a task may run on.
+    enum class Affinity
+    {
+      AnyThread,
+      MainThread
+    };
+
+  private: // types
+
+    struct Task
+    {
+      string           Name;
+      function<void()> Function;
+      vector<uint32_t> Reads;
+      vector<uint32_t> Writes;
+      Affinity         Thread;
+
+      // Tasks which wait for this one, and the number this one waits for.
+      vector<size_t>   Dependents;
+      size_t           DependencyCount;
+    };
+
+  private: // data
+
+    // Whether the dependencies are up to date with the added tasks.
+    bool compiled = false;
+
+    // Interned resource names.
+    unordered_map<string, uint32_t> resources;
+
+    vector<Task> tasks;
+
+    // Per-execution state: dependencies left for each task, tasks left in
+    //  the frame, and ready tasks waiting for the main thread.
+    unique_ptr<atomic<size_t>[]> remaining;
+    atomic<size_t>               unfinished;
+    vector<size_t>               mainThreadTasks;
+    mutex                        mainThreadLock;
+
+  public: // properties
+
+    // Number of tasks in the graph.
+    size_t Size() const { return tasks.size(); }
+
+  public: // methods
+
+    FrameGraph()
+    {
+      unfinished = 0;
+    }
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // Adds a task with the names of the resources it reads and writes.
+    void Add(string name, function<void()> fn, const vector<string>& reads, const vector<string>& writes,
+      Affinity affinity = Affinity::AnyThread)
+    {
+      Task task;
+      task.Name = move(name);
+      task.Function = move(fn);
+      task.Thread = affinity;
+      task.DependencyCount = 0;
+      for (auto& resource : reads)  task.Reads.push_back(Intern(resource));
+      for (auto& resource : writes) task.Writes.push_back(Intern(resource));
+
+      tasks.push_back(move(task));
+      compiled = false;
+    }
+
+    // Runs every task once, in parallel where their resources allow, and
+    //  returns when all are done. Must be called from the main thread.
+    //  Without a JobSystem the tasks run in the order they were added.
+    void Execute(JobSystem* jobs = JobSystem::CurrentInstance())
+    {
+      if (!compiled)
+      {
+        Compile();
+      }
+
+      if (!jobs)
+      {
+        for (auto& task : tasks)
+        {
+          task.Function();
+        }
+        return;
+      }
+
+      unfinished = tasks.size();
+      for (size_t i = 0; i < tasks.size(); ++i)
+      {
+        remaining[i] = tasks[i].DependencyCount;
+      }
+
+      JobGroup group;
+      for (size_t i = 0; i < tasks.size(); ++i)
+      {
+        if (tasks[i].DependencyCount == 0)
+        {
+          Schedule(i, *jobs, group);
+        }
+      }
+
+      // Run main thread tasks as they become ready, and help with the
+      //  others while none are.
+      while (unfinished > 0)
+      {
+        size_t task = tasks.size();
+        {
+          lock_guard<mutex> guard(mainThreadLock);
+          if (!mainThreadTasks.empty())
+          {
+            task = mainThreadTasks.back();
+            mainThreadTasks.pop_back();
+          }
+        }
+
+        if (task != tasks.size())
+        {
+          RunTask(task, *jobs, group);
+        }
+        else if (!jobs->RunPending())
+        {
+          this_thread::yield();
+        }
+      }
+
+      jobs->Wait(group);
+    }
+
+  private: // methods
+
+    // Finds each task's dependencies on the tasks added before it.
+    void Compile()
+    {
+      for (auto& task : tasks)
+      {
+        task.Dependents.clear();
+        task.DependencyCount = 0;
+      }
+
+      for (size_t i = 0; i < tasks.size(); ++i)
+      {
+        for (size_t j = 0; j < i; ++j)
+        {
+          if (Overlaps(tasks[i].Writes, tasks[j].Reads) ||
+              Overlaps(tasks[i].Writes, tasks[j].Writes) ||
+              Overlaps(tasks[i].Reads, tasks[j].Writes))
+          {
+            tasks[j].Dependents.push_back(i);
+            ++tasks[i].DependencyCount;
+          }
+        }
+      }
+
+      remaining.reset(new atomic<size_t>[tasks.size()]);
+      compiled = true;
+    }
+
+    // Returns the index of a resource name, adding it if it's new.
+    uint32_t Intern(const string& resource)
+    {
+      auto it = resources.find(resource);
+      if (it != resources.end())
+      {
+        return it->second;
+      }
+
+      uint32_t index = (uint32_t) resources.size();
+      resources[resource] = index;
+      return index;
+    }
+
+    // Whether two resource lists share a resource.
+    static bool Overlaps(const vector<uint32_t>& a, const vector<uint32_t>& b)
+    {
+      for (uint32_t resource : a)
+      {
+        if (find(b.begin(), b.end(), resource) != b.end())
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Runs a task, then schedules the tasks that were only waiting for it.
+    void RunTask(size_t index, JobSystem& jobs, JobGroup& group)
+    {
+      Task& task = tasks[index];
+      task.Function();
+
+      for (size_t dependent : task.Dependents)
+      {
+        if (--remaining[dependent] == 0)
+        {
+          Schedule(dependent, jobs, group);
+        }
+      }
+      --unfinished;
+    }
+
+    // Hands a ready task to the job system or the main thread.
+    void Schedule(size_t index, JobSystem& jobs, JobGroup& group)
+    {
+      if (tasks[index].Thread == Affinity::MainThread)
+      {
+        lock_guard<mutex> guard(mainThreadLock);
+        mainThreadTasks.push_back(index);
+        return;
+      }
+
+      jobs.Run(group, [this, index, &jobs, &group]()
+      {
+        RunTask(index, jobs, group);
+      });
+    }
+  };
+} // namespace lite
@@ -4,51 +4,127 @@
 #include "ComponentManager.hpp"
 #include "Essentials.hpp"
 #include "EventHandler.hpp"
+#include <unordered_map>
 
 namespace lite
 {
+  class ObjectPool;
+
   const GameObject* GetPrefab(const string& name);
+  void ReturnToPool(ObjectPool& pool, GameObject& object);
 
   class GameObject
   {
+  private: // types
+
+    // Entry of the table mapping identifiers to objects. An identifier holds
+    //  the index of its slot in the low 32 bits and the slot's generation at
+    //  the time it was handed out in the high 32 bits.
+    struct Slot
+    {
+      GameObject* Object;
+      uint32_t    Generation;
+    };
+
+    // Objects sharing a name or tag, by name or tag.
+    typedef unordered_map<string, vector<GameObject*>> Index;
+
+    // Where an object is listed in an index. (Objects is null if it isn't)
+    struct IndexEntry
+    {
+      vector<GameObject*>* Objects;
+      size_t               Position;
+    };
+
   private: // data
 
     vector<unique_ptr<GameObject>> children;
-    vector<unique_ptr<IComponent>> components;
+    vector<ComponentHandle>        components;
+    // Bit per component type (see ComponentTypes) set if the object has one,
+    //  and the position of that component in 'components'.
+    uint64_t componentMask = 0;
+    uint8_t  componentSlots[ComponentTypes::MaxTypes];
     bool  destroyFlag = false;
-    uint32_t identifier = GenerateIdentifier();
+    // Incremented along with the versions of everything below this object.
+    //  (see HierarchyVersion)
+    uint32_t hierarchyVersion = 0;
+    uint64_t identifier = AllocateIdentifier(this);
+    // Position of this object in its parent's 'children'.
+    size_t indexInParent = 0;
     bool isActive = true;
+    // Whether this object and all of its parents are active.
+    bool isActiveInHierarchy = true;
+    // Whether the object is listed in the name and tag indices.
+    bool isIndexed = false;
+    // Whether the name is the generated "GO" + identifier, which isn't indexed.
+    bool isNameGenerated = false;
     string name;
+    IndexEntry nameEntry = { nullptr, 0 };
     GameObject* parent = nullptr;
-    vector<GameObject*> toDestroy;
+    // Pool this object goes back to when destroyed instead of being freed.
+    //  (May be null)
+    ObjectPool* pool = nullptr;
+    string tag;
+    IndexEntry tagEntry = { nullptr, 0 };
 
   public: // properties
 
     // Whether the game object and its components are updating.
+    //  (They only update when the parents are active as well.)
     const bool& Active() const { return isActive; }
     // Set whether the game object and its components should update.
     void Active(bool isActive_) 
     { 
       isActive = isActive_;
-      for (auto& component : components)
-      {
-        component->SetActive(isActive);
-      }
+      RefreshActiveInHierarchy();
     }
 
+    // Whether this object and all of its parents are active; inactive
+    //  objects and everything below them are skipped by per-frame passes.
+    const bool& ActiveInHierarchy() const { return isActiveInHierarchy; }
+
     // Children game objects attached to this game object.
     const vector<unique_ptr<GameObject>>& Children() const { return children; }
 
+    // Incremented whenever this object or one of its parents is attached,
+    //  detached or moved in memory, or gains or loses components. Caches of
+    //  lookups up the hierarchy compare against it to know when they need to
+    //  be resolved again; changes elsewhere in the scene leave it alone.
+    const uint32_t& HierarchyVersion() const { return hierarchyVersion; }
+
     // Whether this object will be destroyed at the end of the frame.
     const bool& DestroyFlag() const { return destroyFlag; }
 
-    // Unique identifer of this game object.
-    const uint32_t& Identifier() const { return identifier; }
+    // Whether this object and its children can be found by name and tag.
+    //  Objects take the setting of the parent they are added below, and
+    //  objects without a parent aren't indexed unless set, so that only
+    //  objects in a scene are found and not prefabs or loose copies.
+    const bool& Indexed() const { return isIndexed; }
+    void Indexed(bool indexed)
+    {
+      if (indexed == isIndexed) return;
+      isIndexed = indexed;
+      RefreshIndexEntries();
+      for (auto& child : children)
+      {
+        child->Indexed(indexed);
+      }
+    }
+
+    // Unique identifer of this game object. Identifiers of destroyed
+    //  objects are never handed out again.
+    const uint64_t& Identifier() const { return identifier; }
 
     // Name of this game object. (May be empty)
     const string& Name() const { return name; }
     // Changes the name of the game object.
-    void Name(string name_) { name = move(name_); }
+    void Name(string name_)
+    {
+      RemoveFromIndex(NameIndex(), &GameObject::nameEntry, name);
+      name = move(name_);
+      isNameGenerated = false;
+      AddToIndex(NameIndex(), &GameObject::nameEntry, name);
+    }
 
     // Pointer to the parent game object. (May be null)
     GameObject* const& Parent() const { return parent; }
@@ -61,14 +137,23 @@ namespace lite
       return *parent;
     }
 
+    // Tag shared by a group of objects, e.g. "Enemy". (May be empty)
+    const string& Tag() const { return tag; }
+    void Tag(string tag_)
+    {
+      RemoveFromIndex(TagIndex(), &GameObject::tagEntry, tag);
+      tag = move(tag_);
+      AddToIndex(TagIndex(), &GameObject::tagEntry, tag);
+    }
+
   public: // methods
 
     explicit GameObject(bool active = true) :
       isActive(active),
+      isActiveInHierarchy(active),
+      isNameGenerated(true),
       name("GO" + to_string(identifier))
-    {
-      Instances()[identifier] = this;
-    }
+    {}
 
     GameObject(const char* filename) : GameObject()
     {
@@ -83,33 +168,64 @@ namespace lite
     GameObject(GameObject&& b) :
       children(move(b.children)),
       components(move(b.components)),
+      componentMask(b.componentMask),
       destroyFlag(b.destroyFlag),
+      hierarchyVersion(b.hierarchyVersion),
       identifier(b.identifier),
+      indexInParent(b.indexInParent),
       isActive(b.isActive),
+      isActiveInHierarchy(b.isActiveInHierarchy),
+      isIndexed(b.isIndexed),
+      isNameGenerated(b.isNameGenerated),
       name(move(b.name)),
       parent(b.parent),
-      toDestroy(move(b.toDestroy))
+      pool(b.pool),
+      tag(move(b.tag))
     {
-      Instances()[identifier] = this;
+      memcpy(componentSlots, b.componentSlots, sizeof(componentSlots));
+      AdoptChildrenAndComponents();
+      TakeIndexEntry(b, &GameObject::nameEntry);
+      TakeIndexEntry(b, &GameObject::tagEntry);
+
+      // Take over b's identifier and give b a new one.
+      Slots()[uint32_t(identifier)].Object = this;
+      b.identifier = AllocateIdentifier(&b);
+      HierarchyChanged();
     }
 
     GameObject& operator=(GameObject&& b)
     {
       children = move(b.children);
       components = move(b.components);
+      componentMask = b.componentMask;
+      memcpy(componentSlots, b.componentSlots, sizeof(componentSlots));
       destroyFlag = b.destroyFlag;
+      hierarchyVersion = b.hierarchyVersion;
       isActive = b.isActive;
+      indexInParent = b.indexInParent;
+      isActiveInHierarchy = b.isActiveInHierarchy;
+      isIndexed = b.isIndexed;
+      isNameGenerated = b.isNameGenerated;
+      RemoveFromIndex(NameIndex(), &GameObject::nameEntry, name);
+      RemoveFromIndex(TagIndex(), &GameObject::tagEntry, tag);
       name = move(b.name);
       parent = b.parent;
-      toDestroy = move(b.toDestroy);
+      pool = b.pool;
+      tag = move(b.tag);
+      AdoptChildrenAndComponents();
+      TakeIndexEntry(b, &GameObject::nameEntry);
+      TakeIndexEntry(b, &GameObject::tagEntry);
+      HierarchyChanged();
 
       return *this;
     }
 
     GameObject(const GameObject& b) :
-      name(b.name)
+      isNameGenerated(b.isNameGenerated),
+      name(b.name),
+      tag(b.tag)
     {
-      Instances()[identifier] = this;
+      RefreshIndexEntries();
       CopyChildren(b.children);
       CopyComponents(b.components);
     }
@@ -118,7 +234,10 @@ namespace lite
     {
       Clear();
 
+      isNameGenerated = b.isNameGenerated;
       name = b.name;
+      tag = b.tag;
+      RefreshIndexEntries();
       CopyChildren(b.children);
       CopyComponents(b.components);
 
@@ -128,7 +247,7 @@ namespace lite
     virtual ~GameObject() 
     {
       Clear();
-      Instances().erase(identifier);
+      ReleaseIdentifier(identifier);
     }
 
     // Adds a new blank child object.
@@ -180,7 +299,7 @@ namespace lite
         component.Initialize();
 
         // Propagate the active flag to the new component.
-        component.SetActive(isActive);
+        component.SetActive(isActiveInHierarchy);
       }
 
       return component;
@@ -212,10 +331,19 @@ namespace lite
         is >> s1 >> s2 >> s3;
       }
       if (s1 != "name" || s2 != "=") return is;
-      name = s3;
+      Name(s3);
+
+      // Read the optional 'tag = XXX'.
+      is >> s1;
+      if (s1 == "tag")
+      {
+        is >> s2 >> s3;
+        if (s2 == "=") Tag(s3);
+        is >> s1;
+      }
 
       // For each child object or component.
-      for (is >> s1; s1 == "["; is >> s1)
+      for (; s1 == "["; is >> s1)
       {
         // Read the type.
         is >> s1 >> s2 >> s3;
@@ -284,27 +412,105 @@ namespace lite
       return is;
     }
 
-    // Destroys this object along with all of its children.
+    // Destroys this object along with all of its children at the end of
+    //  the frame. (see DestroyQueued)
     void Destroy()
     {
-      destroyFlag = true;
+      FatalIf(!parent, "Only child objects can be destroyed; " << name << " has no parent");
+      if (destroyFlag) return;
+
+      // Flag the whole subtree; only this object needs to be queued since
+      //  its children are freed along with it. It is queued by identifier
+      //  since it may still be freed or moved before the end of the frame.
+      SetDestroyFlag(true);
+      DestroyQueue().push_back(identifier);
+    }
 
-      // Destroy each child.
-      for (auto& child : children)
+    // Frees every object destroyed since the last call, removing each from
+    //  its parent's children by swapping the last child into its place.
+    //  Called once at the end of every frame.
+    static void DestroyQueued()
+    {
+      vector<uint64_t>& queue = DestroyQueue();
+      vector<unique_ptr<GameObject>>& freed = FreedObjects();
+      vector<GameObject*>& returned = ReturnedObjects();
+
+      for (size_t i = 0; i < queue.size(); ++i)
+      {
+        // Objects freed some other way since are no longer found, and
+        //  objects already parked in their pool are no longer flagged.
+        GameObject* found = FindByIdentifier(queue[i]);
+        if (!found || !found->destroyFlag) continue;
+        GameObject& object = *found;
+
+        // Objects below another destroyed object go with it.
+        if (object.parent->destroyFlag) continue;
+
+        // Pooled objects are parked in their pool instead. That clears their
+        //  flags, so it waits until every entry has been checked; otherwise
+        //  a child queued after its parent would look alive.
+        if (object.pool)
+        {
+          returned.push_back(&object);
+          continue;
+        }
+
+        freed.push_back(object.DetachFromParent());
+      }
+      queue.clear();
+
+      for (GameObject* object : returned)
       {
-        child->Destroy();
+        object->SetDestroyFlag(false);
+        ReturnToPool(*object->pool, *object);
       }
+      returned.clear();
 
-      // Queue this object to parent's toDestroy list.
-      parent->toDestroy.push_back(this);
+      // Free the objects together; their components go back to their pools
+      //  and the systems drop their resources on their next update.
+      freed.clear();
     }
 
     // Finds a game object by its identifier. (May return null)
-    static GameObject* FindByIdentifier(uint32_t id)
+    static GameObject* FindByIdentifier(uint64_t id)
+    {
+      uint32_t index = uint32_t(id);
+      if (index >= Slots().size()) return nullptr;
+
+      const Slot& slot = Slots()[index];
+      return slot.Generation == uint32_t(id >> 32) ? slot.Object : nullptr;
+    }
+
+    // Takes the identifiers of the objects which were attached, detached or
+    //  moved in memory, or whose components changed, since the last call.
+    //  Objects freed since then are no longer found by their identifier.
+    static void TakeMovedObjects(vector<uint64_t>& objects)
+    {
+      objects.clear();
+      objects.swap(MovedObjects());
+    }
+
+    // Returns a copy of every indexed object with the given tag, in no
+    //  particular order.
+    static vector<GameObject*> FindAllWithTag(const string& tag)
+    {
+      return FindAllIn(TagIndex(), tag);
+    }
+
+    // Returns a copy of every indexed object with the given name, in no
+    //  particular order. Generated names aren't indexed.
+    static vector<GameObject*> FindAllByName(const string& name)
+    {
+      return FindAllIn(NameIndex(), name);
+    }
+
+    // Finds an indexed object by name; any one of them if several share
+    //  the name. Objects destroyed this frame are found until they are
+    //  freed, and inactive ones are found too. (May return null)
+    static GameObject* FindByName(const string& name)
     {
-      auto it = Instances().find(id);
-      if (it == Instances().end()) return nullptr;
-      return it->second;
+      const vector<GameObject*>& objects = FindAllIn(NameIndex(), name);
+      return objects.size() ? objects.front() : nullptr;
     }
 
     // Finds a game object given a predicate condition. (May return null)
@@ -368,34 +574,30 @@ namespace lite
     // Returns the index of a child object. (May return numeric_limits<size_t>::max)
     size_t GetChildIndex(GameObject* object)
     {
-      for (size_t i = 0; i < children.size(); ++i)
-      {
-        if (children[i].get() == object)
-        {
-          return i;
-        }
-      }
-      return size_t(-1);
+      return object && object->parent == this ? object->indexInParent : size_t(-1);
     }
 
     // Returns a component by a type. (May return null)
     template <class T>
     T* GetComponent()
     {
-      IComponent* component =  FindComponentBy([](IComponent& component) 
-      { 
-        return &component.GetType() == &TypeOf<T>(); 
-      });
-      return static_cast<T*>(component);
+      return static_cast<T*>(GetComponentByIndex(ComponentTypes::IndexOf<T>()));
     }
 
     // Returns a component by its type name. (May return null)
     IComponent* GetComponent(const string& typeName)
     {
-      return FindComponentBy([&](IComponent& component) 
-      { 
-        return component.GetType().Name == typeName; 
-      });
+      return GetComponentByIndex(ComponentTypes::Instance().Index(typeName));
+    }
+
+    // Returns a component by the index of its type. (May return null)
+    IComponent* GetComponentByIndex(uint32_t typeIndex)
+    {
+      if (typeIndex >= ComponentTypes::MaxTypes || !(componentMask & (uint64_t(1) << typeIndex)))
+      {
+        return nullptr;
+      }
+      return components[componentSlots[typeIndex]].get();
     }
 
     // Returns a component from type by searching recursively
@@ -403,21 +605,29 @@ namespace lite
     template <class T>
     T* GetComponentUpwards()
     {
-      IComponent* component = FindComponentUpwardsBy([](IComponent& component) 
-      { 
-        return &component.GetType() == &TypeOf<T>(); 
-      });
-      return static_cast<T*>(component);
+      return static_cast<T*>(GetComponentUpwardsByIndex(ComponentTypes::IndexOf<T>()));
     }
 
     // Returns a component from name by searching recursively
     //  through owner objects. (May return null)
     IComponent* GetComponentUpwards(const string& typeName)
     {
-      return FindComponentUpwardsBy([&](IComponent& component)
+      return GetComponentUpwardsByIndex(ComponentTypes::Instance().Index(typeName));
+    }
+
+    // Returns a component by the index of its type by searching
+    //  recursively through owner objects. (May return null)
+    IComponent* GetComponentUpwardsByIndex(uint32_t typeIndex)
+    {
+      for (GameObject* owner = this; owner != nullptr; owner = owner->Parent())
       {
-        return component.GetType().Name == typeName;
-      });
+        IComponent* component = owner->GetComponentByIndex(typeIndex);
+        if (component)
+        {
+          return component;
+        }
+      }
+      return nullptr;
     }
 
     // Initializes components, then child objects.
@@ -454,17 +664,11 @@ namespace lite
     // Calls PullFromSystems function on all components recursively.
     void PullFromSystems()
     {
-      if (!isActive)
-      {
-        // Ensure components are notified that this object is inactive.
-        Active(false);
-      }
+      // Inactive subtrees are skipped entirely.
+      if (!isActiveInHierarchy) return;
 
-      // Call on all components.
-      for (size_t i = 0; i < components.size(); ++i)
-      {
-        components[i]->PullFromSystems();
-      }
+      // Call on the components which implement it.
+      CallComponents(ComponentCallback::PullFromSystems, &IComponent::PullFromSystems);
 
       // Call on all child objects.
       for (size_t i = 0; i < children.size(); ++i)
@@ -476,17 +680,11 @@ namespace lite
     // Calls PullFromSystems function on all components recursively.
     void PushToSystems()
     {
-      if (!isActive)
-      {
-        // Ensure components are notified that this object is inactive.
-        Active(false);
-      }
+      // Inactive subtrees are skipped entirely.
+      if (!isActiveInHierarchy) return;
 
-      // Call on all components.
-      for (size_t i = 0; i < components.size(); ++i)
-      {
-        components[i]->PushToSystems();
-      }
+      // Call on the components which implement it.
+      CallComponents(ComponentCallback::PushToSystems, &IComponent::PushToSystems);
 
       // Call on all child objects.
       for (size_t i = 0; i < children.size(); ++i)
@@ -495,6 +693,22 @@ namespace lite
       }
     }
 
+    // Removes the first component of a type by name, freeing it right away.
+    //  Returns whether the object had one.
+    bool RemoveComponent(const string& typeName)
+    {
+      uint32_t typeIndex = ComponentTypes::Instance().Index(typeName);
+      if (typeIndex == ComponentTypes::NoIndex || !(componentMask & (uint64_t(1) << typeIndex)))
+      {
+        return false;
+      }
+
+      components.erase(components.begin() + componentSlots[typeIndex]);
+      RefreshComponentSlots();
+      HierarchyChanged();
+      return true;
+    }
+
     // Replaces the object with data from a prefab object.
     bool ReplaceWithPrefab(const string& name)
     {
@@ -530,7 +744,12 @@ namespace lite
 
       // Serialize the type and name of the object.
       os << Tabs(level) << "type = " << TypeOf<GameObject>().Name << "\n";
-      os << Tabs(level) << "name = " << Name() << "\n\n";
+      os << Tabs(level) << "name = " << Name() << "\n";
+      if (tag.size())
+      {
+        os << Tabs(level) << "tag = " << Tag() << "\n";
+      }
+      os << "\n";
 
       // For each component:
       for (auto& component : components)
@@ -566,17 +785,24 @@ namespace lite
       return os << Tabs(--level) << "]";
     }
 
-    // Updates child objects, then the components of this object.
-    void Update()
+    // Moves this object along with its children below another object.
+    void SetParent(GameObject& newParent)
     {
-      if (!isActive)
+      FatalIf(!parent, "Only child objects can be moved; " << name << " has no parent");
+      for (GameObject* object = &newParent; object; object = object->parent)
       {
-        // Ensure components are notified that this object is inactive.
-        Active(false);
+        FatalIf(object == this, "Can't move " << name << " below itself");
       }
+      if (&newParent == parent) return;
+
+      newParent.StoreChild(DetachFromParent());
+    }
 
-      // Remember the number of objects requested for destruction last frame.
-      size_t objectsToDestroy = toDestroy.size();
+    // Updates child objects, then the components of this object.
+    void Update()
+    {
+      // Inactive subtrees are skipped entirely.
+      if (!isActiveInHierarchy) return;
 
       // Update children objects.
       for (size_t i = 0; i < children.size(); ++i)
@@ -584,14 +810,8 @@ namespace lite
         children[i]->Update();
       }
 
-      // Update components.
-      for (size_t i = 0; i < components.size(); ++i)
-      {
-        components[i]->Update();
-      }
-
-      // Destroy all objects queued for destruction last frame.
-      toDestroy.erase(toDestroy.begin(), toDestroy.begin() + objectsToDestroy);
+      // Update the components which implement it.
+      CallComponents(ComponentCallback::Update, &IComponent::Update);
     }
 
     // Easy component access. Adds the component if it doesn't exist.
@@ -608,14 +828,164 @@ namespace lite
 
   private: // methods
 
+    // Points moved-in children and components back at this object.
+    void AdoptChildrenAndComponents()
+    {
+      for (auto& child : children)
+      {
+        child->parent = this;
+      }
+      for (auto& component : components)
+      {
+        component->SetOwner(*this);
+      }
+    }
+
+    // Calls a per-frame callback on the components whose types implement it.
+    //  Types which only inherit Component's no-op are skipped without a call.
+    void CallComponents(ComponentCallback callback, void (IComponent::*fn)())
+    {
+      uint64_t mask = componentMask & ComponentTypes::Instance().CallbackMask(callback);
+      if (!mask) return;
+
+      // Only check each component's type if some of them are skipped.
+      bool callAll = mask == componentMask;
+      for (size_t i = 0; i < components.size(); ++i)
+      {
+        IComponent& component = *components[i];
+        if (callAll || (mask & (uint64_t(1) << component.TypeIndex())))
+        {
+          (component.*fn)();
+        }
+      }
+    }
+
+    // Recomputes whether the object is active in the hierarchy. On a change
+    //  the components are notified and the change is passed down to the
+    //  children, so per-frame passes never have to do this themselves.
+    void RefreshActiveInHierarchy()
+    {
+      bool activeInHierarchy = isActive && (!parent || parent->isActiveInHierarchy);
+      if (activeInHierarchy == isActiveInHierarchy) return;
+
+      isActiveInHierarchy = activeInHierarchy;
+      for (auto& component : components)
+      {
+        component->SetActive(isActiveInHierarchy);
+      }
+      for (auto& child : children)
+      {
+        child->RefreshActiveInHierarchy();
+      }
+    }
+
+    // Lists this object in an index under a key, if it is indexed.
+    void AddToIndex(Index& index, IndexEntry GameObject::*entry, const string& key)
+    {
+      if (!isIndexed || key.empty()) return;
+
+      vector<GameObject*>& objects = index[key];
+      IndexEntry& listing = this->*entry;
+      listing.Objects = &objects;
+      listing.Position = objects.size();
+      objects.push_back(this);
+    }
+
+    // Returns the objects listed under a key in an index. Only valid until
+    //  the index changes.
+    static const vector<GameObject*>& FindAllIn(const Index& index, const string& key)
+    {
+      static const vector<GameObject*> none;
+      auto it = index.find(key);
+      return it == index.end() ? none : it->second;
+    }
+
+    // Name index, by object name.
+    static Index& NameIndex()
+    {
+      static Index index;
+      return index;
+    }
+
+    // Lists or unlists the object's name and tag according to 'isIndexed'.
+    void RefreshIndexEntries()
+    {
+      RemoveFromIndex(NameIndex(), &GameObject::nameEntry, name);
+      RemoveFromIndex(TagIndex(), &GameObject::tagEntry, tag);
+      if (!isNameGenerated)
+      {
+        AddToIndex(NameIndex(), &GameObject::nameEntry, name);
+      }
+      AddToIndex(TagIndex(), &GameObject::tagEntry, tag);
+    }
+
+    // Unlists this object from an index, moving the last object listed
+    //  under the same key into its place. The key is dropped with its
+    //  last object, so the index only holds keys in use.
+    void RemoveFromIndex(Index& index, IndexEntry GameObject::*entry, const string& key)
+    {
+      IndexEntry& listing = this->*entry;
+      if (!listing.Objects) return;
+
+      vector<GameObject*>& objects = *listing.Objects;
+      objects[listing.Position] = objects.back();
+      (objects[listing.Position]->*entry).Position = listing.Position;
+      objects.pop_back();
+      listing.Objects = nullptr;
+
+      if (objects.empty())
+      {
+        index.erase(key);
+      }
+    }
+
+    // Tag index, by tag.
+    static Index& TagIndex()
+    {
+      static Index index;
+      return index;
+    }
+
+    // Takes over another object's place in an index.
+    void TakeIndexEntry(GameObject& b, IndexEntry GameObject::*entry)
+    {
+      IndexEntry& listing = b.*entry;
+      this->*entry = listing;
+      if (listing.Objects)
+      {
+        (*listing.Objects)[listing.Position] = this;
+        listing.Objects = nullptr;
+      }
+    }
+
+    // Recomputes the component mask and the position of the first component
+    //  of each type, after components were removed.
+    void RefreshComponentSlots()
+    {
+      componentMask = 0;
+      for (size_t i = 0; i < components.size(); ++i)
+      {
+        uint64_t typeBit = uint64_t(1) << components[i]->TypeIndex();
+        if (!(componentMask & typeBit))
+        {
+          componentMask |= typeBit;
+          componentSlots[components[i]->TypeIndex()] = uint8_t(i);
+        }
+      }
+    }
+
     // Destroys all components and children.
     void Clear()
     {
       children.clear();
       components.clear();
-      toDestroy.clear();
+      componentMask = 0;
       destroyFlag = false;
+      RemoveFromIndex(NameIndex(), &GameObject::nameEntry, name);
+      RemoveFromIndex(TagIndex(), &GameObject::tagEntry, tag);
       name.clear();
+      tag.clear();
+      ++hierarchyVersion;
     }
 
     // Copies all child game objects from an array.
@@ -628,7 +998,7 @@ namespace lite
     }
 
     // Copies all components from an array.
-    void CopyComponents(const vector<unique_ptr<IComponent>>& components)
+    void CopyComponents(const vector<ComponentHandle>& components)
     {
       for (auto& component : components)
       {
@@ -636,18 +1006,129 @@ namespace lite
       }
     }
 
-    // Generates a new unique identifier for the game object.
-    static uint32_t GenerateIdentifier()
+    // Takes this object out of its parent's children by swapping the last
+    //  child into its place.
+    unique_ptr<GameObject> DetachFromParent()
     {
-      static uint32_t id = 0;
-      return id++;
+      vector<unique_ptr<GameObject>>& siblings = parent->children;
+      size_t index = indexInParent;
+      unique_ptr<GameObject> object = move(siblings[index]);
+      if (index + 1 != siblings.size())
+      {
+        siblings[index] = move(siblings.back());
+        siblings[index]->indexInParent = index;
+      }
+      siblings.pop_back();
+      HierarchyChanged();
+      return object;
+    }
+
+    // Hands out the identifier of a free slot and points the slot at an object.
+    static uint64_t AllocateIdentifier(GameObject* object)
+    {
+      uint32_t index;
+      if (FreeSlots().size())
+      {
+        index = FreeSlots().back();
+        FreeSlots().pop_back();
+      }
+      else
+      {
+        FatalIf(Slots().size() == numeric_limits<uint32_t>::max(), "Too many game objects");
+        index = uint32_t(Slots().size());
+        Slot slot = { nullptr, 0 };
+        Slots().push_back(slot);
+      }
+
+      Slot& slot = Slots()[index];
+      slot.Object = object;
+      return (uint64_t(slot.Generation) << 32) | index;
+    }
+
+    // Objects destroyed this frame, waiting for DestroyQueued.
+    static vector<uint64_t>& DestroyQueue()
+    {
+      static vector<uint64_t> queue;
+      return queue;
+    }
+
+    // Sets the destroy flag of this object and everything below it.
+    void SetDestroyFlag(bool flag)
+    {
+      destroyFlag = flag;
+      for (auto& child : children)
+      {
+        child->SetDestroyFlag(flag);
+      }
+    }
+
+    // Objects being freed by DestroyQueued; kept to reuse its memory.
+    static vector<unique_ptr<GameObject>>& FreedObjects()
+    {
+      static vector<unique_ptr<GameObject>> freed;
+      return freed;
+    }
+
+    // Pooled objects being parked by DestroyQueued; kept to reuse its memory.
+    static vector<GameObject*>& ReturnedObjects()
+    {
+      static vector<GameObject*> returned;
+      return returned;
+    }
+
+    // Indices of slots which can be handed out again.
+    static vector<uint32_t>& FreeSlots()
+    {
+      static vector<uint32_t> freeSlots;
+      return freeSlots;
     }
 
-    // Stores a map of all GameObject instances by id.
-    static unordered_map<uint32_t, GameObject*>& Instances()
+    // Records that this object was attached, detached or moved in memory, or
+    //  that its components changed, so everything below it may now have a
+    //  different closest parent component.
+    void HierarchyChanged()
     {
-      static unordered_map<uint32_t, GameObject*> instances;
-      return instances;
+      InvalidateHierarchyVersions();
+      MovedObjects().push_back(identifier);
+    }
+
+    // Increments the hierarchy version of this object and everything below.
+    void InvalidateHierarchyVersions()
+    {
+      ++hierarchyVersion;
+      for (auto& child : children)
+      {
+        child->InvalidateHierarchyVersions();
+      }
+    }
+
+    // Identifiers of the objects recorded by HierarchyChanged since the last
+    //  call to TakeMovedObjects.
+    static vector<uint64_t>& MovedObjects()
+    {
+      static vector<uint64_t> moved;
+      return moved;
+    }
+
+    // Invalidates an identifier. The slot's generation moves on so the old
+    //  identifier never matches again; a slot whose generation would wrap
+    //  around is retired instead of being reused.
+    static void ReleaseIdentifier(uint64_t id)
+    {
+      uint32_t index = uint32_t(id);
+      Slot& slot = Slots()[index];
+      slot.Object = nullptr;
+      if (++slot.Generation != 0)
+      {
+        FreeSlots().push_back(index);
+      }
+    }
+
+    // Maps identifiers to game objects.
+    static vector<Slot>& Slots()
+    {
+      static vector<Slot> slots;
+      return slots;
     }
 
     // Adds a child object directly into the current list of objects.
@@ -655,17 +1136,43 @@ namespace lite
     {
       children.push_back(move(object));
       children.back()->parent = this;
+      children.back()->indexInParent = children.size() - 1;
+      children.back()->RefreshActiveInHierarchy();
+      children.back()->Indexed(isIndexed);
+      children.back()->HierarchyChanged();
       return *children.back();
     }
 
     // Adds a component directly into the current list of components.
-    IComponent& StoreComponent(unique_ptr<IComponent> component)
+    IComponent& StoreComponent(ComponentHandle component)
     {
       FatalIf(!component, "Null component being stored in GameObject");
+      FatalIf(components.size() > numeric_limits<uint8_t>::max(), "Too many components on GameObject " << name);
       components.push_back(move(component));
       components.back()->SetOwner(*this);
+
+      // Components added below an inactive object start inactive.
+      if (!isActiveInHierarchy)
+      {
+        components.back()->SetActive(false);
+      }
+
+      // Remember where the first component of each type is stored.
+      uint64_t typeBit = uint64_t(1) << components.back()->TypeIndex();
+      if (!(componentMask & typeBit))
+      {
+        componentMask |= typeBit;
+        componentSlots[components.back()->TypeIndex()] = uint8_t(components.size() - 1);
+      }
+      HierarchyChanged();
       return *components.back();
     }
+
+    // Builds copies of prefabs in batches. (see Spawning)
+    friend class InstantiationPlan;
+
+    // Recycles destroyed copies of prefabs. (see ObjectPool)
+    friend class ObjectPool;
   };
 
   // Bind GameObject to reflection.
@@ -678,11 +1185,16 @@ namespace lite
         Constructor<>,
         // properties
         "Active", Const(&T::Active), NonConst(&T::Active),
+        "ActiveInHierarchy", Const(&T::ActiveInHierarchy), ReadOnly,
         "Children", Const(&T::Children), ReadOnly,
         "DestroyFlag", Const(&T::DestroyFlag), ReadOnly,
+        "Indexed", Const(&T::Indexed), NonConst(&T::Indexed),
         "Name", Const(&T::Name), NonConst(&T::Name),
+        "Tag", Const(&T::Tag), NonConst(&T::Tag),
         // methods
-        "AddChild", Overloaded<>::Get(&T::AddChild));
+        "AddChild", Overloaded<>::Get(&T::AddChild),
+        "FindAllWithTag", &T::FindAllWithTag,
+        "FindByName", &T::FindByName);
     }
   };
 
@@ -691,6 +1203,11 @@ namespace lite
   struct Binding<vector<unique_ptr<GameObject>>> : vectorBinding<unique_ptr<GameObject>>
   {};
 
+  // Bind the arrays of objects found by name or tag to reflection.
+  template<>
+  struct Binding<vector<GameObject*>> : vectorBinding<GameObject*>
+  {};
+
   // Bind the unique_ptr<GameObject> for child objects.
   template<>
   struct Binding<unique_ptr<GameObject>> : unique_ptrBinding<GameObject>
@@ -700,13 +1217,13 @@ namespace lite
   {
   private: // data
 
-    uint32_t id = (uint32_t)-1;
+    uint64_t id = ~uint64_t(0);
 
   public: // methods
 
     GOId() = default;
 
-    GOId(uint32_t id_) : 
+    GOId(uint64_t id_) : 
       id(id_)
     {}
 
@@ -730,7 +1247,7 @@ namespace lite
       return id == b.id;
     }
 
-    bool operator==(uint32_t id) const
+    bool operator==(uint64_t id) const
     {
       return this->id == id;
     }
@@ -740,7 +1257,7 @@ namespace lite
       return !(*this == b);
     }
 
-    bool operator!=(uint32_t id) const
+    bool operator!=(uint64_t id) const
     {
       return !(*this == id);
     }
@@ -6,11 +6,18 @@
 #include "DebugDrawer.hpp"
 #include "EventHandler.hpp"
 #include "ModelInstance.hpp"
-#include <unordered_map>
+#include "RenderFrame.hpp"
 #include "Window.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace lite
 {
+  // Draws the models submitted by the simulation. Models are copied into
+  //  the back one of two render frames; at the end of each simulation frame
+  //  the frames are swapped and the front one is drawn on the render thread
+  //  while the simulation fills the back one with the next frame.
   class Graphics : public LightSingleton<Graphics>
   {
   private: // types
@@ -27,8 +34,19 @@ namespace lite
     BufferHandle cbScene;
     D3DInfo d3d;
     InputLayoutHandle inputLayout;
-    size_t modelCounter = 0;
-    unordered_map<size_t, shared_ptr<ModelInstance>> models;
+
+    // The frame being filled by the simulation and the frame being drawn.
+    RenderFrame frames[2];
+    RenderFrame* backFrame = &frames[0];
+    RenderFrame* frontFrame = &frames[1];
+
+    // Render thread state; the render thread draws the front frame while
+    //  'frontReady' is set and clears it when done.
+    bool                    frontReady = false;
+    bool                    quit = false;
+    mutex                   renderLock;
+    condition_variable      renderSignal;
+    thread                  renderThread;
 
   public: // data
 
@@ -38,7 +56,9 @@ namespace lite
 
   public: // methods
 
-    Graphics(Window& window)
+    // Creates the device and, unless told not to, the render thread which
+    //  becomes the only user of the immediate context.
+    Graphics(Window& window, bool threadedRendering = true)
     {
       // Create the device and swap chain.
       DXGI_SWAP_CHAIN_DESC swapChainDesc;
@@ -157,31 +177,98 @@ namespace lite
       rasterDesc.ScissorEnable = false;
       rasterDesc.SlopeScaledDepthBias = 0;
       d3d.Device->CreateRasterizerState(&rasterDesc, d3d.NoCullRasterizer);
+
+      if (threadedRendering)
+      {
+        renderThread = thread([this]() { RenderLoop(); });
+      }
+    }
+
+    Graphics(const Graphics&) = delete;
+    Graphics& operator=(const Graphics&) = delete;
+
+    ~Graphics()
+    {
+      if (renderThread.joinable())
+      {
+        {
+          lock_guard<mutex> guard(renderLock);
+          quit = true;
+        }
+        renderSignal.notify_all();
+        renderThread.join();
+      }
+    }
+
+    // Copies a model into the frame being built. Invisible models are skipped.
+    void Submit(const ModelInstance& model)
+    {
+      if (model.IsVisible)
+      {
+        backFrame->Add(model);
+      }
     }
 
-    // Adds a new model instance.
-    shared_ptr<ModelInstance> AddModel()
+    // Shares a model with the frame being built, drawn with the given world
+    //  transform instead of its own. Only the pointer and matrix are copied,
+    //  so the model must not change until the frame is drawn.
+    void Submit(shared_ptr<const ModelInstance> model, const float4x4& transform)
     {
-      auto result = models.emplace(modelCounter++, make_shared<ModelInstance>());
-      auto it = result.first;
-      return it->second;
+      if (model->IsVisible)
+      {
+        backFrame->Add(move(model), transform);
+      }
     }
 
+    // Ends the simulation's frame: waits for the previous frame to finish
+    //  drawing, then swaps the frames and starts drawing this one.
     void Update(float dt)
     {
-      // Remove all models no longer being referenced.
-      for (auto it = models.begin(); it != models.end();)
+      DebugDrawer::Instance().Flush(*backFrame);
+      backFrame->ViewProjection = Camera.ViewProjectionMatrix();
+
+      if (!renderThread.joinable())
       {
-        if (it->second.unique())
-        {
-          it = models.erase(it);
-        }
-        else
-        {
-          ++it;
-        }
+        swap(backFrame, frontFrame);
+        backFrame->Clear();
+        Render(*frontFrame);
+        return;
+      }
+
+      unique_lock<mutex> guard(renderLock);
+      renderSignal.wait(guard, [this]() { return !frontReady; });
+
+      swap(backFrame, frontFrame);
+      backFrame->Clear();
+      frontReady = true;
+      guard.unlock();
+      renderSignal.notify_all();
+    }
+
+  private: // methods
+
+    // Draws the front frame each time the simulation hands one over.
+    void RenderLoop()
+    {
+      while (true)
+      {
+        unique_lock<mutex> guard(renderLock);
+        renderSignal.wait(guard, [this]() { return quit || frontReady; });
+        if (quit) return;
+        guard.unlock();
+
+        Render(*frontFrame);
+
+        guard.lock();
+        frontReady = false;
+        guard.unlock();
+        renderSignal.notify_all();
       }
+    }
 
+    // Draws a frame to the back buffer and presents it.
+    void Render(RenderFrame& frame)
+    {
       if (!d3d.Context || !d3d.RenderTarget) return;
 
       // Clear the render target.
@@ -226,7 +313,7 @@ namespace lite
       XMStoreFloat4x4(
         &sceneConstants.viewProjection,
         XMMatrixTranspose(
-        XMLoadFloat4x4(&Camera.ViewProjectionMatrix())));
+        XMLoadFloat4x4(&frame.ViewProjection)));
       sceneConstants.lightDirections = { lightDirections[0], lightDirections[1] };
       sceneConstants.lightColors = { lightColors[0], lightColors[1] };
 
@@ -234,14 +321,8 @@ namespace lite
       d3d.Context->VSSetConstantBuffers(0, 1, cbScene);
       d3d.Context->PSSetConstantBuffers(0, 1, cbScene);
 
-      // Draw all models.
-      for (auto& modelPair : models)
-      {
-        modelPair.second->Draw();
-      }
-
-      // Debug drawing.
-      DebugDrawer::Instance().Update();
+      // Draw all models, including debug drawing.
+      frame.Draw();
 
       // Present the back buffer to the display.
       d3d.SwapChain->Present(0, 0);
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "Essentials.hpp"
+
+namespace lite
+{
+  // Counts the unfinished jobs started in it. Waiting on a group with
+  //  JobSystem::Wait joins all of them, running other jobs meanwhile.
+  class JobGroup
+  {
+  private: // data
+
+    atomic<size_t> pending;
+
+  public: // properties
+
+    // Whether every job started in the group has finished.
+    bool IsDone() const { return pending == 0; }
+
+  public: // methods
+
+    JobGroup()
+    {
+      pending = 0;
+    }
+
+    JobGroup(const JobGroup&) = delete;
+    JobGroup& operator=(const JobGroup&) = delete;
+
+    friend class JobSystem;
+  };
+
+  // Work-stealing job system. Each worker thread owns a queue; a job started
+  //  from a worker goes to the back of that worker's queue, and workers take
+  //  their own newest jobs first while idle ones steal the oldest jobs from
+  //  the others. Jobs started from any other thread share one more queue.
+  //  Threads waiting on a JobGroup run jobs instead of blocking, so jobs can
+  //  fork and join further jobs without deadlocking the pool.
+  class JobSystem : public LightSingleton<JobSystem>
+  {
+  private: // types
+
+    struct Job
+    {
+      function<void()> Function;
+      JobGroup*        Group;
+    };
+
+    struct Queue
+    {
+      deque<Job> Jobs;
+      mutex      Lock;
+    };
+
+    // The system a worker thread belongs to and its index there.
+    struct Worker
+    {
+      const JobSystem* System;
+      size_t           Index;
+    };
+
+  private: // data
+
+    // Number of jobs sitting in queues, used to let workers sleep.
+    atomic<size_t> queuedJobs;
+
+    // One queue per worker followed by the queue shared by other threads.
+    vector<unique_ptr<Queue>> queues;
+
+    // Whether the workers should exit.
+    bool quit = false;
+
+    // Workers sleep on this when every queue is empty.
+    mutex              sleepLock;
+    condition_variable wake;
+
+    vector<thread> threads;
+
+  public: // properties
+
+    // Number of worker threads, not counting threads which wait on groups.
+    size_t ThreadCount() const { return threads.size(); }
+
+  public: // methods
+
+    // Creates the worker threads. By default one less than the number of
+    //  hardware threads, leaving one for the main thread.
+    explicit JobSystem(size_t threadCount = DefaultThreadCount())
+    {
+      queuedJobs = 0;
+      for (size_t i = 0; i <= threadCount; ++i)
+      {
+        queues.push_back(make_unique<Queue>());
+      }
+      for (size_t i = 0; i < threadCount; ++i)
+      {
+        threads.emplace_back([this, i]() { WorkerLoop(i); });
+      }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem()
+    {
+      {
+        lock_guard<mutex> guard(sleepLock);
+        quit = true;
+      }
+      wake.notify_all();
+
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+    }
+
+    // One less than the number of hardware threads.
+    static size_t DefaultThreadCount()
+    {
+      size_t hardwareThreads = thread::hardware_concurrency();
+      return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    // Calls fn(chunkBegin, chunkEnd) for chunks of at most 'grain' indices
+    //  covering [begin, end) as jobs, and returns once all are done. Small
+    //  loops and loops on a system without workers run inline.
+    void ParallelFor(size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)>& fn)
+    {
+      if (begin >= end) return;
+
+      grain = max(grain, size_t(1));
+      if (threads.empty() || end - begin <= grain)
+      {
+        fn(begin, end);
+        return;
+      }
+
+      // Start all chunks but the first, which this thread runs itself.
+      JobGroup group;
+      for (size_t chunk = begin + grain; chunk < end; chunk += grain)
+      {
+        size_t chunkEnd = min(chunk + grain, end);
+        Run(group, [&fn, chunk, chunkEnd]() { fn(chunk, chunkEnd); });
+      }
+      fn(begin, min(begin + grain, end));
+
+      Wait(group);
+    }
+
+    // Starts a job in a group. (fork)
+    void Run(JobGroup& group, function<void()> fn)
+    {
+      ++group.pending;
+
+      Queue& queue = *queues[ThreadIndex()];
+      {
+        lock_guard<mutex> guard(queue.Lock);
+        Job job = { move(fn), &group };
+        queue.Jobs.push_back(move(job));
+      }
+
+      // Wake a sleeping worker.
+      {
+        lock_guard<mutex> guard(sleepLock);
+        ++queuedJobs;
+      }
+      wake.notify_one();
+    }
+
+    // Runs one queued job if there is one. Returns whether a job was run.
+    bool RunPending()
+    {
+      Job job;
+      if (!TakeJob(ThreadIndex(), job))
+      {
+        return false;
+      }
+
+      job.Function();
+      --job.Group->pending;
+      return true;
+    }
+
+    // Index of the calling worker thread, or ThreadCount() for any other
+    //  thread. Indexes the queue the thread pushes its jobs to.
+    size_t ThreadIndex() const
+    {
+      const Worker& worker = CurrentWorker();
+      return worker.System == this ? worker.Index : threads.size();
+    }
+
+    // Returns once every job in the group has finished, running queued jobs
+    //  while waiting. (join)
+    void Wait(JobGroup& group)
+    {
+      while (!group.IsDone())
+      {
+        if (!RunPending())
+        {
+          this_thread::yield();
+        }
+      }
+    }
+
+  private: // methods
+
+    // The worker running on the calling thread, set by WorkerLoop. Other
+    //  threads have no system. Thread-local storage rather than a search
+    //  of 'threads', since every Run and RunPending asks for it.
+    static Worker& CurrentWorker()
+    {
+      __declspec(thread) static Worker worker = { nullptr, 0 };
+      return worker;
+    }
+
+    // Takes the newest job from a queue, or steals the oldest from another.
+    bool TakeJob(size_t own, Job& job)
+    {
+      for (size_t i = 0; i < queues.size(); ++i)
+      {
+        size_t index = (own + i) % queues.size();
+        Queue& queue = *queues[index];
+
+        lock_guard<mutex> guard(queue.Lock);
+        if (queue.Jobs.empty()) continue;
+
+        if (index == own)
+        {
+          job = move(queue.Jobs.back());
+          queue.Jobs.pop_back();
+        }
+        else
+        {
+          job = move(queue.Jobs.front());
+          queue.Jobs.pop_front();
+        }
+        --queuedJobs;
+        return true;
+      }
+      return false;
+    }
+
+    void WorkerLoop(size_t index)
+    {
+      Worker& worker = CurrentWorker();
+      worker.System = this;
+      worker.Index = index;
+
+      while (true)
+      {
+        Job job;
+        if (TakeJob(index, job))
+        {
+          job.Function();
+          --job.Group->pending;
+          continue;
+        }
+
+        // Sleep until a job is queued or the system shuts down.
+        unique_lock<mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return quit || queuedJobs > 0; });
+        if (quit) return;
+      }
+    }
+  };
+} // namespace lite
@@ -1,19 +1,33 @@
 #include "Precompiled.hpp"
 #include "Audio.hpp"
+#include "BudgetedWork.hpp"
+#include "CollisionDetector.hpp"
+#include "ComponentManager.hpp"
+#include "DebugDrawer.hpp"
+#include "FrameGraph.hpp"
 #include "FrameTimer.hpp"
 #include "GameObject.hpp"
 #include "Graphics.hpp"
 #include "Input.hpp"
+#include "JobSystem.hpp"
 #include "LogicTimer.hpp"
 #include "Physics.hpp"
+#include "Pose.hpp"
 #include "Reflection.hpp"
+#include "SceneCommands.hpp"
 #include "Scripting.hpp"
 #include "Window.hpp"
 
 #include "CollisionComponents.hpp"
 #include "Model.hpp"
+#include "ObjectPool.hpp"
 #include "RigidBody.hpp"
+#include "Spawning.hpp"
+#include "Sway.hpp"
 #include "Transform.hpp"
+#include "TransformBenchmark.hpp"
+#include "TransformHierarchy.hpp"
+#include "UpdateScheduler.hpp"
 
 #include "LuaCppInterfaceInclude.hpp"
 #include "PrefabManager.hpp"
@@ -24,23 +38,90 @@ int CALLBACK WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 
   // Initialize our systems.
   auto audio    = Audio();
-  auto physics = Physics(true, {0, -6, 0});
+  Physics physics(true, {0, -6, 0});
   auto window   = Window("Lite Game Engine", 960, 540);
-  auto graphics = Graphics(window);
+  Graphics graphics(window);
+  TransformHierarchy transforms;
+  JobSystem jobs;
+  SceneCommands sceneCommands(jobs);
+  UpdateScheduler updateRates;
+  BudgetedWork budgetedWork;
 
   RegisterComponent<Model>();
   RegisterComponent<PlaneCollision>();
   RegisterComponent<RigidBody>();
   RegisterComponent<SphereCollision>();
+  RegisterComponent<Sway>();
   RegisterComponent<Transform>();
 
+  // VS2013 doesn't make the initialization of function-local statics
+  //  thread-safe, and most frame tasks run on workers, so the singletons
+  //  those tasks use are created here before the first frame.
+  PoseArray::Instance();
+  CollisionDetector::Instance();
+  ComponentManager::Instance();
+  ComponentTypes::Instance();
+  DebugDrawer::Instance();
+
   Note(Reflection::Instance());
 
   auto scene = GameObject("Scene.txt");
+  scene.Indexed(true);
 
   auto& spongebobPrefab = *GetPrefab("Bee");
+  auto spongebobPlan = InstantiationPlan(spongebobPrefab);
+  // Bees shot from the camera; the oldest is recycled past the limit.
+  ObjectPool shotBees(spongebobPrefab, scene);
+  deque<uint64_t> liveShots;
+  const size_t maxShots = 32;
+  // Build the pool's bees over the first frames instead of all up front.
+  budgetedWork.Submit([&]()
+  {
+    shotBees.WarmUp(4);
+    return shotBees.Stats().Created >= maxShots;
+  }, 1.0);
   auto frameTimer = FrameTimer();
 
+  // The frame's work, with the resources each part reads and writes so
+  //  that independent parts overlap: audio runs beside the transform and
+  //  physics updates. Graphics only hands the frame to the render thread,
+  //  which draws it while the next frame is simulated.
+  using Affinity = FrameGraph::Affinity;
+  FrameGraph frame;
+  frame.Add("Logic", [&]()
+  {
+    updateRates.BeginFrame(frameTimer.DeltaTime(), graphics.Camera.Position());
+    scene.Update();
+  },
+    { "Input" }, { "Scene" }, Affinity::MainThread);
+  // Compute world matrices changed by game logic before systems read them.
+  frame.Add("Transforms", [&]() { transforms.Update(); },
+    { "Scene", "Poses" }, { "Transforms" });
+  frame.Add("PushToSystems", [&]() { scene.PushToSystems(); },
+    { "Scene", "Poses", "Transforms" }, { "PhysicsWorld", "RenderList" });
+  frame.Add("Audio", [&]() { audio.Update(); },
+    { "Scene" }, { "Audio", "Events" });
+  frame.Add("Physics", [&]() { physics.Update(frameTimer.IdealDeltaTime()); },
+    {}, { "PhysicsWorld", "Poses" });
+  // Pick up the poses physics moved.
+  frame.Add("PhysicsTransforms", [&]() { transforms.Update(); },
+    { "Scene", "Poses" }, { "Transforms" });
+  frame.Add("Window", [&]() { window.Update(); },
+    {}, { "Input", "Events", "Window" }, Affinity::MainThread);
+  frame.Add("Graphics", [&]() { graphics.Update(frameTimer.DeltaTime()); },
+    { "Window" }, { "RenderList", "Graphics" }, Affinity::MainThread);
+  frame.Add("PullFromSystems", [&]() { scene.PullFromSystems(); },
+    { "Poses", "Transforms" }, { "Scene" });
+  // Spend the frame's budget on deferred work.
+  frame.Add("BudgetedWork", [&]() { budgetedWork.Run(); },
+    {}, { "Scene", "Poses", "Transforms", "PhysicsWorld" }, Affinity::MainThread);
+  // Apply the structural changes recorded during the frame.
+  frame.Add("SceneCommands", [&]() { sceneCommands.Playback(); },
+    {}, { "Scene", "Poses", "Transforms", "PhysicsWorld" }, Affinity::MainThread);
+  // Free the objects destroyed during the frame.
+  frame.Add("DestroyObjects", [&]() { GameObject::DestroyQueued(); },
+    {}, { "Scene", "Poses", "Transforms", "PhysicsWorld" }, Affinity::MainThread);
+
   // Game loop:
   while (window.IsOpen())
   {
@@ -63,28 +144,43 @@ int CALLBACK WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
     
     if (Input::IsTriggered(VK_ESCAPE))  window.Destroy();
     if (Input::IsTriggered(VK_F1))      DebugDrawCollisions() = !DebugDrawCollisions();
+    if (Input::IsTriggered(VK_F2))      Note(BenchmarkTransforms());
+    if (Input::IsTriggered(VK_F4))      Note(updateRates);
 
     if (Input::IsTriggered(VK_SPACE))
     {
-      GameObject& child = scene.AddChild(spongebobPrefab);
-      child[Transform_].LocalPosition = graphics.Camera.Position();
+      Pose pose;
+      pose.Position = graphics.Camera.Position();
+      GameObject& child = shotBees.Spawn(&pose);
       child[RigidBody_].AddForce(Vector(graphics.Camera.Look()) * 300);
+
+      liveShots.push_back(child.Identifier());
+      if (liveShots.size() > maxShots)
+      {
+        if (GameObject* oldest = GameObject::FindByIdentifier(liveShots.front()))
+        {
+          oldest->Destroy();
+        }
+        liveShots.pop_front();
+      }
+    }
+
+    // Drop a 10x10 grid of bees above the camera.
+    if (Input::IsTriggered(VK_F3))
+    {
+      float3 center = graphics.Camera.Position();
+      vector<Pose> poses(100);
+      for (size_t i = 0; i < poses.size(); ++i)
+      {
+        poses[i].Position = { center.x + float(i % 10) * 3 - 15, center.y + 10, center.z + float(i / 10) * 3 - 15 };
+      }
+      spongebobPlan.Instantiate(scene, poses.size(), poses.data());
     }
 
     graphics.Camera.RotateY((float) Input::GetMouseDeltaX() / 100);
     graphics.Camera.Pitch((float) Input::GetMouseDeltaY() / 100);
 
-    scene.Update();
-
-    scene.PushToSystems();
-
-    // Update all systems.
-    audio.Update();
-    physics.Update(frameTimer.IdealDeltaTime());
-    window.Update();
-    graphics.Update(frameTimer.DeltaTime());
-
-    scene.PullFromSystems();
+    frame.Execute();
 
     frameTimer.EndFrame();
   }
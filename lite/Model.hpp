@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.hpp"
+#include "CopyOnWrite.hpp"
 #include "GameObject.hpp"
 #include "Graphics.hpp"
 #include "ModelInstance.hpp"
@@ -12,65 +13,78 @@ namespace lite
   {
   private: // data
 
-    shared_ptr<ModelInstance> model;
+    // Render settings, shared with the prefab and every other copy of it
+    //  until changed. The world matrix is added when the model is submitted,
+    //  and frames waiting to be drawn share the settings too, so changing
+    //  them during drawing makes a copy.
+    CopyOnWrite<ModelInstance> model;
+
+    // Whether the model is submitted for drawing.
+    bool isVisible = true;
 
   public: // properties
 
+    // Setting a property to the value it already has keeps the settings
+    //  shared, so resetting a copy to its prefab's values costs no memory.
+
     // Whether backfaces are culled.
     const bool& BackfaceCulling() const { return model->BackfaceCulling; }
-    void BackfaceCulling(bool b) { model->BackfaceCulling = b; }
+    void BackfaceCulling(bool b) { if (b != model->BackfaceCulling) model.Write().BackfaceCulling = b; }
 
     // Color of the model (ignored unless the shader uses it).
     const float4& Color() const { return model->Color; }
-    void Color(const float4& c) { model->Color = c; }
+    void Color(const float4& c) { if (memcmp(&c, &model->Color, sizeof(c))) model.Write().Color = c; }
 
     // Name of the material used to render the mesh.
     const string& Material() const { return model->Material; }
-    void Material(string material) { model->Material = move(material); }
+    void Material(string material) { if (material != model->Material) model.Write().Material = move(material); }
 
     // Name of the mesh including extension.
     const string& Mesh() const { return model->Mesh; }
-    void Mesh(string mesh) { model->Mesh = move(mesh); }
+    void Mesh(string mesh) { if (mesh != model->Mesh) model.Write().Mesh = move(mesh); }
 
     // Texture name overriding the material's default texture.
     const string& Texture() const { return model->Texture; }
-    void Texture(string texture) { model->Texture = move(texture); }
+    void Texture(string texture) { if (texture != model->Texture) model.Write().Texture = move(texture); }
 
   public: // methods
 
     Model()
-    {
-      model = Graphics::CurrentInstance()->AddModel();
-    }
+    {}
 
-    Model(const Model& b)
-    {
-      model = Graphics::CurrentInstance()->AddModel();
+    // Shares the render settings of the copied model.
+    Model(const Model& b) :
+      model(b.model)
+    {}
 
-      BackfaceCulling(b.BackfaceCulling());
-      Color(b.Color());
-      Material(b.Material());
-      Mesh(b.Mesh());
-      Texture(b.Texture());
+    // Shares the render settings of the other model.
+    Model& operator=(const Model& b)
+    {
+      model = b.model;
+      return *this;
     }
 
   private: // methods
 
     void Activate() override
     {
-      model->IsVisible = true;
+      isVisible = true;
     }
 
     void Deactivate() override
     {
-      model->IsVisible = false;
+      isVisible = false;
     }
 
     void PushToSystems() override
     {
+      if (!isVisible) return;
       Transform& tfm = OwnerReference()[Transform_];
-      model->Transform = tfm.GetWorldMatrix();
+      Graphics::CurrentInstance()->Submit(model.Share(), tfm.GetWorldMatrix());
     }
+
+    // Lets Component see which callbacks are overridden.
+    friend class Component<Model>;
   };
 
   template<>
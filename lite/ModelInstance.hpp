@@ -36,7 +36,13 @@ namespace lite
 
   public: // methods
 
-    void Draw()
+    void Draw() const
+    {
+      Draw(Transform);
+    }
+
+    // Draws the model with the given world transform instead of its own.
+    void Draw(const float4x4& transform) const
     {
       if (!IsVisible) return;
 
@@ -53,7 +59,7 @@ namespace lite
 
       // Initialize per-object constants to be sent into the shaders.
       MeshData::ObjectConstants constants;
-      XMStoreFloat4x4(&constants.world, XMMatrixTranspose(XMLoadFloat4x4(&Transform)));
+      XMStoreFloat4x4(&constants.world, XMMatrixTranspose(XMLoadFloat4x4(&transform)));
       constants.outputColor = Color;
 
       D3DInfo& d3d = *D3DInfo::CurrentInstance();
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "FieldInfo.hpp"
+#include "GameObject.hpp"
+#include "Pose.hpp"
+#include "Spawning.hpp"
+#include "Transform.hpp"
+#include "TypeInfo.hpp"
+
+namespace lite
+{
+  // Recycles copies of a prefab. Destroying a copy parks it in the pool at
+  //  the end of the frame instead of freeing it: it is deactivated, which
+  //  takes it out of every per-frame pass and out of physics, and its fields
+  //  are reset to the prefab's through reflection. Spawning reactivates a
+  //  parked copy and only builds a new one when none are left.
+  //
+  //  Copies are children of the pool's parent object, which must outlive
+  //  the pool.
+  class ObjectPool
+  {
+  public: // types
+
+    struct Statistics
+    {
+      // Copies built by the pool, including warm-up.
+      size_t Created = 0;
+
+      // Copies currently spawned and not yet returned.
+      size_t InUse = 0;
+
+      // Most copies that were in use at the same time.
+      size_t HighWaterMark = 0;
+
+      // Copies returned to the pool by being destroyed.
+      size_t Returned = 0;
+
+      // Spawns served by a parked copy rather than a new one.
+      size_t Reused = 0;
+
+      // Total number of spawns.
+      size_t Spawned = 0;
+    };
+
+  private: // data
+
+    // Identifiers of every copy made, to detach them if the pool goes first.
+    vector<uint64_t> instances;
+
+    // Object the copies are added to.
+    GameObject& parent;
+
+    // Copies waiting to be spawned.
+    vector<GameObject*> parked;
+
+    InstantiationPlan  plan;
+    const GameObject&  prefab;
+    Statistics         stats;
+
+  public: // properties
+
+    // Number of copies waiting to be spawned.
+    size_t ParkedCount() const { return parked.size(); }
+
+    // Counters on how the pool has been used.
+    const Statistics& Stats() const { return stats; }
+
+  public: // methods
+
+    // Creates a pool of copies of a prefab, added as children of 'parent',
+    //  with 'warmUp' copies built and parked up front.
+    ObjectPool(const GameObject& prefab_, GameObject& parent_, size_t warmUp = 0) :
+      parent(parent_),
+      plan(prefab_),
+      prefab(prefab_)
+    {
+      WarmUp(warmUp);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Copies still around are freed normally once the pool is gone.
+    ~ObjectPool()
+    {
+      for (uint64_t id : instances)
+      {
+        if (GameObject* object = GameObject::FindByIdentifier(id))
+        {
+          object->pool = nullptr;
+        }
+      }
+    }
+
+    // Activates a parked copy, or builds one if none are parked, placing it
+    //  at the given pose (if not null).
+    GameObject& Spawn(const Pose* pose = nullptr)
+    {
+      GameObject* object;
+      if (parked.size())
+      {
+        object = parked.back();
+        parked.pop_back();
+
+        if (pose)
+        {
+          if (Transform* transform = object->GetComponent<Transform>())
+          {
+            transform->SetLocalPosition(pose->Position);
+            transform->SetLocalRotation(pose->Rotation);
+          }
+        }
+        object->Active(true);
+        ++stats.Reused;
+      }
+      else
+      {
+        size_t index = plan.Instantiate(parent, 1, pose);
+        object = parent.Children()[index].get();
+        Adopt(*object);
+      }
+
+      ++stats.Spawned;
+      stats.HighWaterMark = max(stats.HighWaterMark, ++stats.InUse);
+      return *object;
+    }
+
+    // Builds and parks 'count' more copies.
+    void WarmUp(size_t count)
+    {
+      size_t first = plan.Instantiate(parent, count);
+      ReserveMore(parked, count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        GameObject& object = *parent.Children()[first + i];
+        Adopt(object);
+        object.Active(false);
+        parked.push_back(&object);
+      }
+    }
+
+  private: // methods
+
+    // Marks a newly built copy as belonging to the pool.
+    void Adopt(GameObject& object)
+    {
+      object.pool = this;
+      instances.push_back(object.Identifier());
+      ++stats.Created;
+    }
+
+    // Copies the settings of the source's components into the object's,
+    //  and recurses into the children. Returns false if the
+    //  object no longer has the source's layout.
+    static bool Reset(GameObject& object, const GameObject& source)
+    {
+      if (object.children.size() != source.children.size() ||
+          object.components.size() != source.components.size())
+      {
+        return false;
+      }
+
+      if (object.name != source.name) object.Name(source.name);
+      if (object.tag != source.tag) object.Tag(source.tag);
+
+      for (size_t i = 0; i < source.components.size(); ++i)
+      {
+        IComponent* sourceComponent = source.components[i].get();
+        IComponent* component = object.components[i].get();
+
+        if (&component->GetType() != &sourceComponent->GetType()) return false;
+
+        component->ResetFrom(*sourceComponent);
+      }
+
+      for (size_t i = 0; i < source.children.size(); ++i)
+      {
+        if (!Reset(*object.children[i], *source.children[i])) return false;
+      }
+
+      return true;
+    }
+
+    // Parks a destroyed copy.
+    void Return(GameObject& object)
+    {
+      object.Active(false);
+
+      // Copies whose objects or components were changed are rebuilt.
+      if (!Reset(object, prefab))
+      {
+        object = prefab;
+        object.Initialize();
+      }
+
+      parked.push_back(&object);
+      --stats.InUse;
+      ++stats.Returned;
+    }
+
+    friend void ReturnToPool(ObjectPool& pool, GameObject& object);
+  };
+
+  // Parks a destroyed copy in the pool it came from. (see GameObject::Destroy)
+  inline void ReturnToPool(ObjectPool& pool, GameObject& object)
+  {
+    pool.Return(object);
+  }
+
+  // Prints the statistics of a pool.
+  inline ostream& operator<<(ostream& os, const ObjectPool::Statistics& stats)
+  {
+    return os <<
+      "Pool: " << stats.InUse << " in use (peak " << stats.HighWaterMark << "), " <<
+      stats.Created << " created, " << stats.Reused << " of " << stats.Spawned << " spawns reused, " <<
+      stats.Returned << " returned";
+  }
+} // namespace lite
@@ -5,7 +5,11 @@
 #include "ContactResolver.hpp"
 #include "D3DInclude.hpp"
 #include "Essentials.hpp"
+#include "ForceField.hpp"
+#include "PhysicsRecorder.hpp"
 #include "PhysicsRigidBody.hpp"
+#include "PhysicsSnapshot.hpp"
+#include "PhysicsStats.hpp"
 
 //================================================================================================//
 // This engine is an implementation of "Game Physics Engine Development" by Ian Millington using  //
@@ -24,37 +28,77 @@ namespace lite
   {
   private: // data
 
-    // Whether a gravity actor should be added to bodies by default.
-    bool addDefaultGravity = true;
-
     // Array of rigid bodies.
     vector<shared_ptr<PhysicsRigidBody>> bodies;
 
+    // Changed whenever removing bodies renumbers the rest. (see Snapshot)
+    uint32_t bodyLayout = 0;
+
     // Stores all contacts and basic properties for this frame.
     CollisionData collisionData;
 
     // Array of all collision primitives.
     vector<shared_ptr<CollisionPrimitive>> collisionPrimitives;
 
-    // Actor attached to bodies by default.
-    function<void(PhysicsRigidBody&, float)> defaultGravityActor;
+    // Fields applying forces to many bodies at once.
+    vector<shared_ptr<ForceField>> forceFields;
+
+    // Pairs of primitives found by the broadphase to be tested for contacts.
+    vector<pair<CollisionPrimitive*, CollisionPrimitive*>> pairs;
+
+    // Captures every simulation step to a file. (May be null)
+    unique_ptr<PhysicsRecorder> recorder;
+
+    // While recording: the state of the bodies after the last recorded step,
+    //  and the bodies changed since from outside the simulation.
+    PhysicsSnapshot recordedState;
+    PhysicsSnapshot externalChanges;
 
     // Resolves collisions reported by the CollisionDetector.
     ContactResolver resolver;
 
+    // Statistics gathered during the last update.
+    PhysicsStats stats;
+
+    // File that statistics are streamed to. (May be null)
+    unique_ptr<ofstream> statsLog;
+
+    // Number of updates run so far.
+    size_t updateCount = 0;
+
   public: // data
 
+    // Maximum number of contacts resolved per simulation iteration. When more
+    //  contacts are generated the least important ones (shallow and slowly
+    //  closing) are dropped, so heavy scenes degrade gracefully instead of
+    //  the resolver's iteration count exploding. Zero disables the budget.
+    size_t ContactBudget = 256;
+
+    // Maximum number of contacts kept for any single pair of primitives.
+    size_t MaxContactsPerPair = 4;
+
     // Number of times to run the entire scene simulation.
     //  Running multiple times will prevent objects from flying
     //  through each other.
     size_t SimulationIterations = 5;
 
+  public: // properties
+
+    // Whether simulation steps are being captured to a file.
+    bool IsRecording() const { return recorder != nullptr; }
+
+    // Timings and counters gathered during the last update.
+    const PhysicsStats& Stats() const { return stats; }
+
   public: // methods
 
-    Physics(bool addGravity = true, float3 defaultGravityVector = { 0, -9.8f, 0 }) :
-      addDefaultGravity(addGravity)
+    Physics(bool addGravity = true, float3 defaultGravityVector = { 0, -9.8f, 0 })
     {
-      defaultGravityActor = [=](PhysicsRigidBody& p, float) { p.AddForce(defaultGravityVector); };
+      // Add a gravity field affecting all bodies if it was requested.
+      if (addGravity)
+      {
+        AddForceField<GravityField>()->Force = defaultGravityVector;
+      }
     }
 
     template <class T>
@@ -68,46 +112,223 @@ namespace lite
       return move(ptr);
     }
 
+    template <class T>
+    shared_ptr<T> AddForceField()
+    {
+      // Create the new field.
+      auto ptr = make_shared<T>();
+      forceFields.push_back(ptr);
+
+      return move(ptr);
+    }
+
     shared_ptr<PhysicsRigidBody> AddRigidBody()
     {
       // Create the new body.
       bodies.emplace_back(Align<16>::New<PhysicsRigidBody>(), Align<16>::Delete<PhysicsRigidBody>);
-      shared_ptr<PhysicsRigidBody>& body = bodies.back();
-      
-      // Add default gravity actor if it was requested at startup.
-      if (addDefaultGravity)
+      bodies.back()->index = uint32_t(bodies.size() - 1);
+      return bodies.back();
+    }
+
+    // Makes room for 'count' more rigid bodies.
+    void ReserveBodies(size_t count)
+    {
+      ReserveMore(bodies, count);
+    }
+
+    // Makes room for 'count' more collision primitives.
+    void ReservePrimitives(size_t count)
+    {
+      ReserveMore(collisionPrimitives, count);
+    }
+
+    // Removes a force field from the simulation.
+    void RemoveForceField(const shared_ptr<ForceField>& field)
+    {
+      forceFields.erase(remove(forceFields.begin(), forceFields.end(), field), forceFields.end());
+    }
+
+    // Starts streaming statistics to a CSV file, one line per simulation
+    //  iteration. Returns false if the file could not be opened.
+    bool LogStats(const string& filename)
+    {
+      statsLog = make_unique<ofstream>(filename);
+      if (!statsLog->is_open())
       {
-        body->Actors.push_back(defaultGravityActor);
+        statsLog = nullptr;
+        return false;
       }
 
-      return body;
+      PhysicsStats::WriteCsvHeader(*statsLog);
+      return true;
+    }
+
+    // Starts capturing every simulation step's inputs, contacts and resulting
+    //  poses to a file which PhysicsReplay can re-simulate deterministically.
+    //  Returns false if the file could not be opened.
+    bool StartRecording(const string& filename)
+    {
+      recorder = make_unique<PhysicsRecorder>();
+      if (!recorder->Open(filename))
+      {
+        recorder = nullptr;
+        return false;
+      }
+
+      return true;
+    }
+
+    // Stops capturing simulation steps and closes the file.
+    void StopRecording()
+    {
+      recorder = nullptr;
+    }
+
+    // Restores the world to a snapshot. A delta snapshot only overwrites the
+    //  bodies it stores, so the world must be at the delta's baseline first.
+    //  Snapshots can't be restored across the removal of a body, since the
+    //  remaining bodies are renumbered.
+    void Restore(const PhysicsSnapshot& snapshot)
+    {
+      FatalIf(snapshot.IsEmpty(), "Restoring an empty physics snapshot");
+      const PhysicsSnapshot::Header& header = snapshot.GetHeader();
+      FatalIf(header.BodyCount != bodies.size(), "Physics snapshot was taken with a different number of bodies");
+      FatalIf(header.BodyLayout != bodyLayout, "Physics snapshot was taken before bodies were removed");
+
+      // Restore the state of each stored body.
+      const PhysicsBodyState* states = snapshot.Bodies();
+      for (uint32_t i = 0; i < header.StoredBodies; ++i)
+      {
+        FatalIf(states[i].Index >= bodies.size(), "Physics snapshot refers to body " << states[i].Index << " out of " << bodies.size());
+        bodies[states[i].Index]->LoadState(states[i]);
+      }
+
+      // Rebuild the contacts from the last simulation step.
+      const PhysicsContactState* contactStates = snapshot.Contacts();
+      collisionData.Contacts.resize(header.ContactCount);
+      for (uint32_t i = 0; i < header.ContactCount; ++i)
+      {
+        const PhysicsContactState& state = contactStates[i];
+        Contact& contact = collisionData.Contacts[i];
+        contact.ContactNormal = state.ContactNormal;
+        contact.ContactPoint = state.ContactPoint;
+        contact.Penetration = state.Penetration;
+        contact.SetBodyData(
+          BodyAtIndex(state.Body[0]), 
+          BodyAtIndex(state.Body[1]), 
+          state.Friction, 
+          state.Restitution);
+      }
+    }
+
+    // Restores the world to a delta snapshot taken against the given baseline.
+    void Restore(const PhysicsSnapshot& delta, const PhysicsSnapshot& baseline)
+    {
+      Restore(baseline);
+      Restore(delta);
+    }
+
+    // Saves the full state of the world.
+    PhysicsSnapshot Snapshot() const
+    {
+      PhysicsSnapshot snapshot;
+      Snapshot(snapshot);
+      return snapshot;
+    }
+
+    // Saves the full state of the world, reusing the snapshot's memory.
+    void Snapshot(PhysicsSnapshot& snapshot) const
+    {
+      uint32_t bodyCount = uint32_t(bodies.size());
+      snapshot.Reset(bodyCount, bodyLayout, bodyCount, uint32_t(collisionData.Contacts.size()), false);
+      SaveContacts(snapshot);
+
+      // Copy every body's state.
+      PhysicsBodyState* states = snapshot.MutableBodies();
+      for (uint32_t i = 0; i < bodyCount; ++i)
+      {
+        bodies[i]->SaveState(states[i]);
+      }
+    }
+
+    // Saves only the bodies which differ from a full baseline snapshot.
+    PhysicsSnapshot Snapshot(const PhysicsSnapshot& baseline) const
+    {
+      PhysicsSnapshot delta;
+      Snapshot(delta, baseline);
+      return delta;
+    }
+
+    // Saves only the bodies which differ from a full baseline
+    //  snapshot, reusing the delta snapshot's memory.
+    void Snapshot(PhysicsSnapshot& delta, const PhysicsSnapshot& baseline) const
+    {
+      FatalIf(baseline.IsEmpty(), "An empty snapshot cannot be used as a baseline");
+      FatalIf(baseline.IsDelta(), "A delta snapshot cannot be used as a baseline");
+      FatalIf(baseline.GetHeader().BodyCount != bodies.size(), "Baseline snapshot was taken with a different number of bodies");
+      FatalIf(baseline.GetHeader().BodyLayout != bodyLayout, "Baseline snapshot was taken before bodies were removed");
+
+      uint32_t bodyCount = uint32_t(bodies.size());
+      delta.Reset(bodyCount, bodyLayout, bodyCount, uint32_t(collisionData.Contacts.size()), true);
+      SaveContacts(delta);
+
+      // Copy each body's state, keeping it only if it changed.
+      const PhysicsBodyState* baselineStates = baseline.Bodies();
+      PhysicsBodyState* states = delta.MutableBodies();
+      uint32_t stored = 0;
+      for (uint32_t i = 0; i < bodyCount; ++i)
+      {
+        bodies[i]->SaveState(states[stored]);
+        if (memcmp(&states[stored], &baselineStates[i], sizeof(PhysicsBodyState)) != 0)
+        {
+          ++stored;
+        }
+      }
+
+      delta.TrimBodies(stored);
     }
 
     void Update(float dt)
     {
+      // Drop bodies and primitives whose components were destroyed.
+      RemoveReleased();
+
+      // Pick up poses game logic wrote into shared slots since the last update.
+      for (auto& body : bodies)
+      {
+        body->PickUpPoseChange();
+      }
+
       // Divide the dt for multiple simulations.
       dt /= (float)SimulationIterations;
 
+      stats.Begin(SimulationIterations);
+
       // Perform the simulation as many times as requested. The more
       //  iterations the less likely objects will fly through each other.
       for (size_t i = 0U; i < SimulationIterations; ++i)
       {
-        // Integrate all bodies.
-        for (auto& body : bodies)
-        {
-          body->ApplyActors(dt);
-          body->Integrate(dt);
-        }
-
-        // Generate contacts.
-        size_t contacts = GenerateContacts();
+        // Force fields and actors count towards the step's integration time.
+        high_resolution_timer timer;
+        ApplyForces(dt);
+        stats.steps[i].IntegrateTime = float(timer.elapsed_milliseconds());
+        Simulate(dt, i);
+      }
 
-        // Resolve contacts.
-        ContactResolver resolver;
-        resolver.PositionIterations = contacts * 2;
-        resolver.VelocityIterations = contacts * 2;
-        resolver.ResolveContacts(collisionData.Contacts, dt);
+      stats.End();
+      if (statsLog)
+      {
+        stats.WriteCsv(*statsLog, updateCount);
       }
+      ++updateCount;
+
+      // Remove fields which have run their course.
+      forceFields.erase(
+        remove_if(forceFields.begin(), forceFields.end(), [](const shared_ptr<ForceField>& field)
+        {
+          return field->IsFinished();
+        }),
+        forceFields.end());
 
       // Clear accumulators for all bodies.
       for (auto& body : bodies)
@@ -119,34 +340,300 @@ namespace lite
 
   private: // methods
 
-    size_t GenerateContacts()
+    friend class PhysicsReplay;
+
+    // Applies all force fields and actors to the bodies' accumulators.
+    void ApplyForces(float dt)
+    {
+      // Apply each force field to all bodies in one pass.
+      for (auto& field : forceFields)
+      {
+        field->Apply(bodies, dt);
+      }
+
+      // Apply the actors on each body.
+      for (auto& body : bodies)
+      {
+        if (body->Actors.size())
+        {
+          body->ApplyActors(dt);
+        }
+      }
+    }
+
+    // Runs one simulation step on the forces already accumulated. When
+    //  recorded inputs are given they replace the accumulated forces
+    //  and awake state of each body, which is how replays are run.
+    void Simulate(float dt, size_t stepIndex, const PhysicsBodyInput* inputs = nullptr)
+    {
+      PhysicsStepStats& step = stats.steps[stepIndex];
+      high_resolution_timer timer;
+
+      // Capture the world whenever it changes, then this step's inputs.
+      if (recorder)
+      {
+        PhysicsWorldSettings settings = { uint32_t(ContactBudget), uint32_t(MaxContactsPerPair) };
+        bool sameBodies = 
+          !recordedState.IsEmpty() &&
+          recordedState.GetHeader().BodyCount == bodies.size() &&
+          recordedState.GetHeader().BodyLayout == bodyLayout;
+        if (recorder->WorldChanged(settings, bodies, collisionPrimitives) || !sameBodies)
+        {
+          recorder->RecordWorld(Snapshot());
+        }
+        else
+        {
+          // Capture bodies moved, woken or disabled from outside the simulation
+          //  since the last step, e.g. by scripts or object pools.
+          SnapshotWithoutForces(externalChanges, &recordedState);
+          if (externalChanges.GetHeader().StoredBodies)
+          {
+            recorder->RecordSnapshot(externalChanges);
+          }
+        }
+        recorder->RecordInputs(bodies);
+      }
+
+      // Integrate all bodies.
+      for (size_t i = 0; i < bodies.size(); ++i)
+      {
+        PhysicsRigidBody& body = *bodies[i];
+        if (!body.Enabled) continue;
+        if (inputs)
+        {
+          body.accumulatedForces = inputs[i].Force;
+          body.accumulatedTorque = inputs[i].Torque;
+          body.isAwake = inputs[i].Awake != 0;
+        }
+        body.Integrate(dt);
+        step.AwakeBodies += body.IsAwake();
+      }
+      step.IntegrateTime += float(timer.elapsed_milliseconds());
+
+      // Find pairs of primitives which may be touching.
+      timer.start();
+      size_t pairCapacity = pairs.capacity();
+      step.Pairs = FindPairs();
+      step.Allocations += pairs.capacity() != pairCapacity;
+      step.BroadphaseTime = float(timer.elapsed_milliseconds());
+
+      // Generate contacts and trim them to the budget.
+      timer.start();
+      size_t contactCapacity = collisionData.Contacts.capacity();
+      size_t contacts = GenerateContacts(dt);
+      step.Allocations += collisionData.Contacts.capacity() != contactCapacity;
+      step.Contacts = contacts;
+      step.NarrowphaseTime = float(timer.elapsed_milliseconds());
+
+      // Resolve contacts.
+      resolver.PositionIterations = contacts * 2;
+      resolver.VelocityIterations = contacts * 2;
+      resolver.ResolveContacts(collisionData.Contacts, dt);
+      step.PositionIterations = resolver.PositionIterationsUsed();
+      step.PositionSolveTime = resolver.PositionSolveTime();
+      step.VelocityIterations = resolver.VelocityIterationsUsed();
+      step.VelocitySolveTime = resolver.VelocitySolveTime();
+
+      // Capture the resolved contacts and resulting poses.
+      if (recorder)
+      {
+        recorder->RecordStep(uint32_t(updateCount), uint32_t(stepIndex), dt, bodies, collisionData.Contacts);
+        SnapshotWithoutForces(recordedState, nullptr);
+      }
+    }
+
+    // Removes every body and primitive no longer referenced outside of the
+    //  simulation, in one pass each. Remaining bodies keep their order so
+    //  that simulation stays deterministic, and are renumbered.
+    void RemoveReleased()
     {
-      // Initialize all primitives.
+      const uint32_t released = ~0U;
+
+      // Mark released bodies, and detach primitives still pointing at them.
+      bool removeBodies = false;
+      for (auto& body : bodies)
+      {
+        if (body.unique())
+        {
+          body->index = released;
+          removeBodies = true;
+        }
+      }
+
+      size_t primitiveCount = collisionPrimitives.size();
+      collisionPrimitives.erase(
+        remove_if(collisionPrimitives.begin(), collisionPrimitives.end(), [](const shared_ptr<CollisionPrimitive>& primitive)
+        {
+          return primitive.unique();
+        }),
+        collisionPrimitives.end());
+
+      if (!removeBodies)
+      {
+        if (primitiveCount != collisionPrimitives.size())
+        {
+          collisionData.Contacts.clear();
+        }
+        return;
+      }
+
       for (auto& primitive : collisionPrimitives)
       {
-        primitive->CalculateInternals();
+        if (primitive->Body && primitive->Body->index == released)
+        {
+          primitive->Body = nullptr;
+        }
+      }
+
+      bodies.erase(
+        remove_if(bodies.begin(), bodies.end(), [=](const shared_ptr<PhysicsRigidBody>& body)
+        {
+          return body->index == released;
+        }),
+        bodies.end());
+
+      for (size_t i = 0; i < bodies.size(); ++i)
+      {
+        bodies[i]->index = uint32_t(i);
       }
+      ++bodyLayout;
+
+      // Contacts from the last step may refer to removed bodies.
+      collisionData.Contacts.clear();
+    }
 
+    // Returns the body at an index stored in a snapshot. (May return null)
+    PhysicsRigidBody* BodyAtIndex(uint32_t index) const
+    {
+      if (index == PhysicsContactState::NoBody) return nullptr;
+      FatalIf(index >= bodies.size(), "Physics snapshot refers to body " << index << " out of " << bodies.size());
+      return bodies[index].get();
+    }
+
+    // Broadphase: updates all primitives and finds the pairs which may be
+    //  touching. Returns the number of pairs found.
+    size_t FindPairs()
+    {
+      // Initialize all primitives attached to an enabled body.
+      for (auto& primitive : collisionPrimitives)
+      {
+        if (primitive->Body && primitive->Body->Enabled)
+        {
+          primitive->CalculateInternals();
+        }
+      }
+
+      CollisionDetector& detector = CollisionDetector::Instance();
+      pairs.clear();
+
+      // Pair up all registered primitives.
+      for (size_t j = 0; j < collisionPrimitives.size(); ++j)
+      {
+        CollisionPrimitive& b = *collisionPrimitives[j];
+        if (!b.Body || !b.Body->Enabled) continue;
+
+        for (size_t i = j + 1; i < collisionPrimitives.size(); ++i)
+        {
+          CollisionPrimitive& a = *collisionPrimitives[i];
+
+          // Skip unattached or disabled primitives, primitives sharing a
+          //  body, and types which can't collide with each other.
+          if (!a.Body || !a.Body->Enabled || a.Body == b.Body || !detector.CanCollide(a, b)) continue;
+
+          pairs.emplace_back(&a, &b);
+        }
+      }
+
+      return pairs.size();
+    }
+
+    // Narrowphase: generates contacts for all pairs found by the
+    //  broadphase. Returns the number of contacts to resolve.
+    size_t GenerateContacts(float dt)
+    {
       // Set up the collision data.
       collisionData.Clear();
       collisionData.Friction = 0.8f;
       collisionData.Restitution = 0.2f;
       collisionData.Tolerance = 0.1f;
 
-      size_t total = 0;
+      // Collide all candidate pairs.
+      for (auto& pair : pairs)
+      {
+        // Keep only the deepest and most spread contacts of the pair.
+        size_t first = collisionData.Contacts.size();
+        if (CollisionDetector::Instance().Collide(*pair.first, *pair.second, collisionData) > MaxContactsPerPair)
+        {
+          collisionData.ReducePairContacts(first, MaxContactsPerPair);
+        }
+      }
 
-      // Collide all registered primitives.
-      for (size_t j = 0; j < collisionPrimitives.size(); ++j)
+      // Drop the least important contacts when over budget.
+      if (ContactBudget)
       {
-        for (size_t i = j + 1; i < collisionPrimitives.size(); ++i)
+        collisionData.EnforceBudget(ContactBudget, dt);
+      }
+
+      return collisionData.Contacts.size();
+    }
+
+    // Saves every body into a full snapshot, or only the bodies which differ
+    //  from a baseline into a delta. Accumulated forces are left out since
+    //  the recorder captures them as step inputs.
+    void SnapshotWithoutForces(PhysicsSnapshot& snapshot, const PhysicsSnapshot* baseline) const
+    {
+      uint32_t bodyCount = uint32_t(bodies.size());
+      snapshot.Reset(bodyCount, bodyLayout, bodyCount, uint32_t(collisionData.Contacts.size()), baseline != nullptr);
+      SaveContacts(snapshot);
+
+      const PhysicsBodyState* baselineStates = baseline ? baseline->Bodies() : nullptr;
+      PhysicsBodyState* states = snapshot.MutableBodies();
+      uint32_t stored = 0;
+      for (uint32_t i = 0; i < bodyCount; ++i)
+      {
+        PhysicsBodyState& state = states[stored];
+        bodies[i]->SaveState(state);
+        state.AccumulatedForces = float3(0, 0, 0);
+        state.AccumulatedTorque = float3(0, 0, 0);
+        if (!baseline || memcmp(&state, &baselineStates[i], sizeof(PhysicsBodyState)) != 0)
         {
-          CollisionPrimitive& a = *collisionPrimitives[i];
-          CollisionPrimitive& b = *collisionPrimitives[j];
-          total += CollisionDetector::Instance().Collide(a, b, collisionData);
+          ++stored;
         }
       }
 
-      return total;
+      snapshot.TrimBodies(stored);
+    }
+
+    // Copies the current contacts into a snapshot.
+    void SaveContacts(PhysicsSnapshot& snapshot) const
+    {
+      PhysicsContactState* states = snapshot.MutableContacts();
+      for (size_t i = 0; i < collisionData.Contacts.size(); ++i)
+      {
+        const Contact& contact = collisionData.Contacts[i];
+        PhysicsContactState& state = states[i];
+        for (size_t b = 0; b < 2; ++b)
+        {
+          state.Body[b] = contact.Body[b] ? contact.Body[b]->Index() : PhysicsContactState::NoBody;
+        }
+        state.ContactNormal = contact.ContactNormal;
+        state.ContactPoint = contact.ContactPoint;
+        state.Friction = contact.Friction;
+        state.Penetration = contact.Penetration;
+        state.Restitution = contact.Restitution;
+      }
+    }
+  };
+
+  // Bind Physics to reflection.
+  template<>
+  struct Binding<Physics> : BindingBase<Physics>
+  {
+    Binding()
+    {
+      Bind(
+        "CurrentInstance", &Physics::CurrentInstance, ReadOnly,
+        "Stats", &T::Stats, ReadOnly);
     }
   };
 } // namespace lite
\ No newline at end of file
@@ -0,0 +1,331 @@
+#pragma once
+
+#include "CollisionPrimitives.hpp"
+#include "Contact.hpp"
+#include "Essentials.hpp"
+#include "PhysicsRigidBody.hpp"
+#include "PhysicsSnapshot.hpp"
+
+namespace lite
+{
+  // Plain description of a collision primitive and its attachment to a body.
+  struct PhysicsPrimitiveDescription
+  {
+    // CollisionPrimitive::PrimitiveType of the primitive.
+    uint32_t Type;
+
+    // Index of the attached body, or PhysicsContactState::NoBody.
+    uint32_t Body;
+
+    float4 OffsetOrientation;
+    float3 OffsetPosition;
+
+    // Plane direction and offset. (Planes only)
+    float3 Direction;
+    float  Offset;
+
+    // Sphere radius. (Spheres only)
+    float  Radius;
+  };
+
+  // Forces acting on a body at the start of a simulation step.
+  struct PhysicsBodyInput
+  {
+    float3   Force;
+    float3   Torque;
+    uint32_t Awake;
+  };
+
+  // Position and orientation of a body at the end of a simulation step.
+  struct PhysicsBodyPose
+  {
+    float3 Position;
+    float4 Orientation;
+  };
+
+  // A contact resolved during a simulation step and the impulse it applied.
+  struct PhysicsContactOutput
+  {
+    PhysicsContactState Contact;
+    float3              Impulse;
+  };
+
+  // Physics settings which change the outcome of a simulation step.
+  struct PhysicsWorldSettings
+  {
+    uint32_t ContactBudget;
+    uint32_t MaxContactsPerPair;
+  };
+
+  // Describes the simulation step stored in a step chunk. Followed by
+  //  BodyCount inputs, ContactCount contacts, and BodyCount poses.
+  struct PhysicsStepRecord
+  {
+    uint32_t Update;
+    uint32_t Step;
+    float    DeltaTime;
+    uint32_t BodyCount;
+    uint32_t ContactCount;
+  };
+
+  // Streams every simulation step's inputs and outputs to a binary capture file
+  //  which PhysicsReplay can re-simulate. The file is a sequence of chunks:
+  //
+  //  World:    world settings, body properties and primitive descriptions,
+  //            written when the world is first seen and whenever settings,
+  //            bodies or primitives change.
+  //  Snapshot: full PhysicsSnapshot of the world following each World chunk,
+  //            or a delta of the bodies changed from outside the simulation
+  //            since the last step, e.g. moved by a script or disabled.
+  //  Step:     a PhysicsStepRecord followed by its inputs, contacts and poses.
+  class PhysicsRecorder
+  {
+  public: // types
+
+    enum ChunkType : uint32_t
+    {
+      WorldChunk = 1,
+      SnapshotChunk = 2,
+      StepChunk = 3
+    };
+
+    struct ChunkHeader
+    {
+      uint32_t Type;
+      uint32_t Size;
+    };
+
+    // Outcome of reading a chunk.
+    enum ReadStatus
+    {
+      ChunkRead,
+      EndOfFile,
+      MalformedChunk
+    };
+
+    // Identifies capture files: "LPRC".
+    static const uint32_t FileMagic = 0x4352504C;
+
+    // Format of the chunks, written after the magic number.
+    static const uint32_t FileVersion = 2;
+
+    // Chunks larger than this are taken as corrupt rather than allocated.
+    static const uint32_t MaxChunkSize = 256 << 20;
+
+  private: // data
+
+    // Scratch arrays reused for every step.
+    vector<PhysicsBodyProperties>       bodyProperties;
+    vector<PhysicsContactOutput>        contacts;
+    vector<PhysicsBodyInput>            inputs;
+    vector<PhysicsBodyPose>             poses;
+    vector<PhysicsPrimitiveDescription> primitives;
+    PhysicsWorldSettings                settings;
+
+    // Last world description written to the file.
+    vector<PhysicsBodyProperties>       recordedBodyProperties;
+    vector<PhysicsPrimitiveDescription> recordedPrimitives;
+    PhysicsWorldSettings                recordedSettings;
+    bool                                recordedWorld = false;
+
+    ofstream file;
+
+  public: // methods
+
+    // Opens the capture file. Returns false if it couldn't be opened.
+    bool Open(const string& filename)
+    {
+      file.open(filename, ios::binary | ios::trunc);
+      if (!file.is_open()) return false;
+
+      file.write(reinterpret_cast<const char*>(&FileMagic), sizeof(FileMagic));
+      file.write(reinterpret_cast<const char*>(&FileVersion), sizeof(FileVersion));
+      return true;
+    }
+
+    // Reads the next chunk of a capture file into 'payload'. A chunk cut
+    //  short or larger than MaxChunkSize is malformed.
+    static ReadStatus ReadChunk(istream& is, ChunkHeader& header, vector<uint8_t>& payload)
+    {
+      if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      {
+        return is.gcount() == 0 ? EndOfFile : MalformedChunk;
+      }
+      if (header.Size > MaxChunkSize) return MalformedChunk;
+
+      payload.resize(header.Size);
+      if (header.Size && !is.read(reinterpret_cast<char*>(payload.data()), header.Size))
+      {
+        return MalformedChunk;
+      }
+      return ChunkRead;
+    }
+
+    // Saves the forces about to be integrated for each body.
+    void RecordInputs(const vector<shared_ptr<PhysicsRigidBody>>& bodies)
+    {
+      inputs.resize(bodies.size());
+      for (size_t i = 0; i < bodies.size(); ++i)
+      {
+        inputs[i].Force = bodies[i]->AccumulatedForces();
+        inputs[i].Torque = bodies[i]->AccumulatedTorque();
+        inputs[i].Awake = bodies[i]->IsAwake();
+      }
+    }
+
+    // Writes a step chunk with the inputs saved by RecordInputs
+    //  along with the resolved contacts and final poses.
+    void RecordStep(
+      uint32_t update, 
+      uint32_t step, 
+      float dt, 
+      const vector<shared_ptr<PhysicsRigidBody>>& bodies,
+      const aligned_vector<Contact>& resolvedContacts)
+    {
+      // Save the contacts and their impulses.
+      contacts.resize(resolvedContacts.size());
+      for (size_t i = 0; i < resolvedContacts.size(); ++i)
+      {
+        const Contact& contact = resolvedContacts[i];
+        PhysicsContactOutput& output = contacts[i];
+        for (size_t b = 0; b < 2; ++b)
+        {
+          output.Contact.Body[b] = contact.Body[b] ? contact.Body[b]->Index() : PhysicsContactState::NoBody;
+        }
+        output.Contact.ContactNormal = contact.ContactNormal;
+        output.Contact.ContactPoint = contact.ContactPoint;
+        output.Contact.Friction = contact.Friction;
+        output.Contact.Penetration = contact.Penetration;
+        output.Contact.Restitution = contact.Restitution;
+        output.Impulse = contact.Impulse;
+      }
+
+      // Save the final poses.
+      poses.resize(bodies.size());
+      for (size_t i = 0; i < bodies.size(); ++i)
+      {
+        poses[i].Position = bodies[i]->Position();
+        poses[i].Orientation = bodies[i]->Orientation();
+      }
+
+      PhysicsStepRecord record;
+      record.Update = update;
+      record.Step = step;
+      record.DeltaTime = dt;
+      record.BodyCount = uint32_t(bodies.size());
+      record.ContactCount = uint32_t(contacts.size());
+
+      WriteChunkHeader(StepChunk, sizeof(record) + ByteSize(inputs) + ByteSize(contacts) + ByteSize(poses));
+      file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+      WriteArray(inputs);
+      WriteArray(contacts);
+      WriteArray(poses);
+    }
+
+    // Writes the world description and a snapshot of it.
+    void RecordWorld(const PhysicsSnapshot& snapshot)
+    {
+      uint32_t bodyCount = uint32_t(bodyProperties.size());
+      uint32_t primitiveCount = uint32_t(primitives.size());
+
+      WriteChunkHeader(WorldChunk, 
+        sizeof(settings) +
+        sizeof(bodyCount) + ByteSize(bodyProperties) + 
+        sizeof(primitiveCount) + ByteSize(primitives));
+      file.write(reinterpret_cast<const char*>(&settings), sizeof(settings));
+      file.write(reinterpret_cast<const char*>(&bodyCount), sizeof(bodyCount));
+      WriteArray(bodyProperties);
+      file.write(reinterpret_cast<const char*>(&primitiveCount), sizeof(primitiveCount));
+      WriteArray(primitives);
+
+      RecordSnapshot(snapshot);
+
+      recordedBodyProperties = bodyProperties;
+      recordedPrimitives = primitives;
+      recordedSettings = settings;
+      recordedWorld = true;
+    }
+
+    // Writes a snapshot chunk. A delta is restored over the replayed world.
+    void RecordSnapshot(const PhysicsSnapshot& snapshot)
+    {
+      WriteChunkHeader(SnapshotChunk, snapshot.Size());
+      file.write(static_cast<const char*>(snapshot.Data()), snapshot.Size());
+    }
+
+    // Describes the current settings, bodies and primitives, and returns
+    //  whether they differ from the last world description written.
+    bool WorldChanged(
+      const PhysicsWorldSettings& settings_,
+      const vector<shared_ptr<PhysicsRigidBody>>& bodies,
+      const vector<shared_ptr<CollisionPrimitive>>& collisionPrimitives)
+    {
+      bool settingsChanged = !recordedWorld || memcmp(&settings_, &recordedSettings, sizeof(settings)) != 0;
+      settings = settings_;
+
+      bodyProperties.resize(bodies.size());
+      for (size_t i = 0; i < bodies.size(); ++i)
+      {
+        bodies[i]->SaveProperties(bodyProperties[i]);
+      }
+
+      primitives.resize(collisionPrimitives.size());
+      for (size_t i = 0; i < collisionPrimitives.size(); ++i)
+      {
+        Describe(*collisionPrimitives[i], primitives[i]);
+      }
+
+      return 
+        settingsChanged ||
+        !SameBytes(bodyProperties, recordedBodyProperties) || 
+        !SameBytes(primitives, recordedPrimitives);
+    }
+
+  private: // methods
+
+    template <class T>
+    static size_t ByteSize(const vector<T>& v)
+    {
+      return v.size() * sizeof(T);
+    }
+
+    // Fills in the description of a collision primitive.
+    static void Describe(const CollisionPrimitive& primitive, PhysicsPrimitiveDescription& description)
+    {
+      memset(&description, 0, sizeof(description));
+      description.Type = primitive.Type();
+      description.Body = primitive.Body ? primitive.Body->Index() : PhysicsContactState::NoBody;
+      description.OffsetOrientation = primitive.OffsetFromBody.Orientation();
+      description.OffsetPosition = primitive.OffsetFromBody.Position();
+
+      switch (primitive.Type())
+      {
+      case CollisionType::Plane:
+        description.Direction = static_cast<const CollisionPlane&>(primitive).Direction;
+        description.Offset = static_cast<const CollisionPlane&>(primitive).Offset;
+        break;
+      case CollisionType::Sphere:
+        description.Radius = static_cast<const CollisionSphere&>(primitive).Radius;
+        break;
+      }
+    }
+
+    template <class T>
+    static bool SameBytes(const vector<T>& a, const vector<T>& b)
+    {
+      return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), ByteSize(a)) == 0);
+    }
+
+    template <class T>
+    void WriteArray(const vector<T>& v)
+    {
+      file.write(reinterpret_cast<const char*>(v.data()), ByteSize(v));
+    }
+
+    void WriteChunkHeader(ChunkType type, size_t size)
+    {
+      ChunkHeader header = { type, uint32_t(size) };
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+  };
+} // namespace lite
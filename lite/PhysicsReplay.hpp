@@ -0,0 +1,316 @@
+#pragma once
+
+#include "chrono.hpp"
+#include "Essentials.hpp"
+#include "Physics.hpp"
+#include "PhysicsRecorder.hpp"
+
+namespace lite
+{
+  // Re-simulates a capture file written by PhysicsRecorder and checks that
+  //  every step reproduces the recorded contacts and poses bit for bit.
+  //  Intended for headless tools; the replay owns its own physics world,
+  //  which replaces Physics::CurrentInstance during Run. The instance that
+  //  was current before is made current again once Run returns.
+  class PhysicsReplay
+  {
+  public: // types
+
+    struct Result
+    {
+      // Whether the file could be opened and has the expected format.
+      bool Loaded = false;
+
+      // Whether the replay stopped early at a truncated or corrupt chunk.
+      bool Malformed = false;
+
+      // Number of steps replayed, and how many of them diverged.
+      size_t Steps = 0;
+      size_t MismatchedSteps = 0;
+
+      // Update and step index of the first diverging step.
+      uint32_t FirstMismatchUpdate = 0;
+      uint32_t FirstMismatchStep = 0;
+
+      // Largest distance between a recorded and a replayed body position.
+      float MaxPositionError = 0;
+
+      // Time spent simulating, excluding file reading.
+      double SimulateMilliseconds = 0;
+    };
+
+  private: // data
+
+    unique_ptr<Physics> physics;
+
+    // Physics::CurrentInstance before the replay built its world.
+    Physics* previous = nullptr;
+
+  public: // methods
+
+    PhysicsReplay() = default;
+    PhysicsReplay(const PhysicsReplay&) = delete;
+    PhysicsReplay& operator=(const PhysicsReplay&) = delete;
+
+    ~PhysicsReplay()
+    {
+      EndWorld();
+    }
+
+    // Replays an entire capture file.
+    Result Run(const string& filename)
+    {
+      Result result;
+
+      ifstream file(filename, ios::binary);
+      uint32_t magic = 0;
+      uint32_t version = 0;
+      if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || magic != PhysicsRecorder::FileMagic ||
+          !file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != PhysicsRecorder::FileVersion)
+      {
+        return result;
+      }
+      result.Loaded = true;
+
+      PhysicsRecorder::ChunkHeader header;
+      vector<uint8_t> payload;
+      bool adoptBodyLayout = false;
+      PhysicsRecorder::ReadStatus status;
+      while ((status = PhysicsRecorder::ReadChunk(file, header, payload)) == PhysicsRecorder::ChunkRead)
+      {
+        switch (header.Type)
+        {
+        case PhysicsRecorder::WorldChunk:
+          if (!BuildWorld(payload))
+          {
+            return StopMalformed(result, "world", filename);
+          }
+          adoptBodyLayout = true;
+          break;
+
+        case PhysicsRecorder::SnapshotChunk:
+          if (physics)
+          {
+            PhysicsSnapshot snapshot;
+            if (!snapshot.Assign(payload.data(), payload.size()))
+            {
+              return StopMalformed(result, "snapshot", filename);
+            }
+
+            // A rebuilt world takes on the numbering of the recorded one.
+            if (adoptBodyLayout)
+            {
+              physics->bodyLayout = snapshot.GetHeader().BodyLayout;
+              adoptBodyLayout = false;
+            }
+            physics->Restore(snapshot);
+          }
+          break;
+
+        case PhysicsRecorder::StepChunk:
+          if (physics && !ReplayStep(payload, result))
+          {
+            return StopMalformed(result, "step", filename);
+          }
+          break;
+        }
+      }
+
+      if (status == PhysicsRecorder::MalformedChunk)
+      {
+        return StopMalformed(result, "chunk", filename);
+      }
+
+      EndWorld();
+      return result;
+    }
+
+  private: // methods
+
+    // Rebuilds the physics world from a world chunk. Returns false if the
+    //  chunk is malformed.
+    bool BuildWorld(const vector<uint8_t>& payload)
+    {
+      const uint8_t* data = payload.data();
+      const uint8_t* end = data + payload.size();
+
+      // Destroy the old world first so the new one stays the current instance.
+      if (!physics)
+      {
+        previous = Physics::CurrentInstance();
+      }
+      physics = nullptr;
+      physics = make_unique<Physics>(false);
+
+      // Simulate with the recorded world's settings.
+      PhysicsWorldSettings settings;
+      if (!Read(data, end, settings)) return false;
+      physics->ContactBudget = settings.ContactBudget;
+      physics->MaxContactsPerPair = settings.MaxContactsPerPair;
+
+      // Add the bodies.
+      uint32_t bodyCount;
+      const PhysicsBodyProperties* properties;
+      if (!Read(data, end, bodyCount) || !ReadArray(data, end, bodyCount, properties)) return false;
+      for (uint32_t i = 0; i < bodyCount; ++i)
+      {
+        physics->AddRigidBody()->LoadProperties(properties[i]);
+      }
+
+      // Add the primitives and attach them to their bodies.
+      uint32_t primitiveCount;
+      const PhysicsPrimitiveDescription* descriptions;
+      if (!Read(data, end, primitiveCount) || !ReadArray(data, end, primitiveCount, descriptions)) return false;
+      for (uint32_t i = 0; i < primitiveCount; ++i)
+      {
+        const PhysicsPrimitiveDescription& description = descriptions[i];
+        if (description.Body != PhysicsContactState::NoBody && description.Body >= bodyCount) return false;
+
+        shared_ptr<CollisionPrimitive> primitive;
+        switch (description.Type)
+        {
+        case CollisionType::Plane:
+        {
+          auto plane = physics->AddCollisionPrimitive<CollisionPlane>();
+          plane->Direction = description.Direction;
+          plane->Offset = description.Offset;
+          primitive = plane;
+          break;
+        }
+        case CollisionType::Sphere:
+        {
+          auto sphere = physics->AddCollisionPrimitive<CollisionSphere>();
+          sphere->Radius = description.Radius;
+          primitive = sphere;
+          break;
+        }
+        default:
+          Warn("Unknown collision primitive type " << description.Type << " in physics capture");
+          continue;
+        }
+
+        primitive->Body = physics->BodyAtIndex(description.Body);
+        primitive->OffsetFromBody = RigidTransform(description.OffsetOrientation, description.OffsetPosition);
+      }
+      return true;
+    }
+
+    // Destroys the replay's world and makes the previous world current.
+    void EndWorld()
+    {
+      if (!physics) return;
+
+      physics = nullptr;
+      Physics::MakeCurrent(previous);
+      previous = nullptr;
+    }
+
+    // Stops the replay at a malformed chunk.
+    Result& StopMalformed(Result& result, const char* chunk, const string& filename)
+    {
+      Warn("Malformed " << chunk << " in physics capture " << filename);
+      result.Malformed = true;
+      EndWorld();
+      return result;
+    }
+
+    // Reads a value from a payload. Returns false if too few bytes are left.
+    template <class T>
+    static bool Read(const uint8_t*& data, const uint8_t* end, T& value)
+    {
+      if (size_t(end - data) < sizeof(T)) return false;
+      memcpy(&value, data, sizeof(T));
+      data += sizeof(T);
+      return true;
+    }
+
+    // Points 'values' at 'count' values in a payload. Returns false if too
+    //  few bytes are left.
+    template <class T>
+    static bool ReadArray(const uint8_t*& data, const uint8_t* end, uint32_t count, const T*& values)
+    {
+      if (uint64_t(end - data) < uint64_t(count) * sizeof(T)) return false;
+      values = reinterpret_cast<const T*>(data);
+      data += count * sizeof(T);
+      return true;
+    }
+
+    // Runs a recorded step and compares its output to the recording.
+    //  Returns false if the chunk is malformed.
+    bool ReplayStep(const vector<uint8_t>& payload, Result& result)
+    {
+      const uint8_t* data = payload.data();
+      const uint8_t* end = data + payload.size();
+      PhysicsStepRecord record;
+      const PhysicsBodyInput* inputs;
+      const PhysicsContactOutput* contacts;
+      const PhysicsBodyPose* poses;
+      if (!Read(data, end, record) ||
+          record.BodyCount != physics->bodies.size() ||
+          !ReadArray(data, end, record.BodyCount, inputs) ||
+          !ReadArray(data, end, record.ContactCount, contacts) ||
+          !ReadArray(data, end, record.BodyCount, poses))
+      {
+        return false;
+      }
+
+      // Simulate the step on the recorded inputs.
+      high_resolution_timer timer;
+      physics->stats.Begin(1);
+      physics->Simulate(record.DeltaTime, 0, inputs);
+      result.SimulateMilliseconds += timer.elapsed_milliseconds();
+      ++result.Steps;
+
+      bool matches = physics->collisionData.Contacts.size() == record.ContactCount;
+
+      // Compare the resolved contacts.
+      for (uint32_t i = 0; matches && i < record.ContactCount; ++i)
+      {
+        const Contact& contact = physics->collisionData.Contacts[i];
+        const PhysicsContactOutput& recorded = contacts[i];
+
+        PhysicsContactOutput replayed;
+        memset(&replayed, 0, sizeof(replayed));
+        for (size_t b = 0; b < 2; ++b)
+        {
+          replayed.Contact.Body[b] = contact.Body[b] ? contact.Body[b]->Index() : PhysicsContactState::NoBody;
+        }
+        replayed.Contact.ContactNormal = contact.ContactNormal;
+        replayed.Contact.ContactPoint = contact.ContactPoint;
+        replayed.Contact.Friction = contact.Friction;
+        replayed.Contact.Penetration = contact.Penetration;
+        replayed.Contact.Restitution = contact.Restitution;
+        replayed.Impulse = contact.Impulse;
+
+        matches = memcmp(&replayed, &recorded, sizeof(PhysicsContactOutput)) == 0;
+      }
+
+      // Compare the poses, tracking how far the positions drifted.
+      for (uint32_t i = 0; i < record.BodyCount; ++i)
+      {
+        const PhysicsRigidBody& body = *physics->bodies[i];
+
+        PhysicsBodyPose replayed;
+        replayed.Position = body.Position();
+        replayed.Orientation = body.Orientation();
+        if (memcmp(&replayed, &poses[i], sizeof(PhysicsBodyPose)) != 0)
+        {
+          matches = false;
+          float error = (Vector(replayed.Position) - Vector(poses[i].Position)).Length();
+          result.MaxPositionError = max(result.MaxPositionError, error);
+        }
+      }
+
+      if (!matches)
+      {
+        if (result.MismatchedSteps == 0)
+        {
+          result.FirstMismatchUpdate = record.Update;
+          result.FirstMismatchStep = record.Step;
+        }
+        ++result.MismatchedSteps;
+      }
+      return true;
+    }
+  };
+} // namespace lite
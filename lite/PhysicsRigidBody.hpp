@@ -1,6 +1,9 @@
 #pragma once
 
+#include "PhysicsSnapshot.hpp"
 #include "PhysicsUtility.hpp"
+#include "Pose.hpp"
+#include "RigidTransform.hpp"
 
 namespace lite
 {
@@ -30,6 +33,9 @@ namespace lite
     //  inertia tensor member is specified in the body's local space.
     float4x4 inverseInertiaTensorWorld;
 
+    // Index of the body in the physics world's array of bodies.
+    uint32_t index = 0;
+
     // Holds the inverse of the mass of the rigid body. It is more useful to hold the
     //  inverse mass because integration is simpler, and because in real-time
     //  simulation it is more useful to have bodies with infinite mass (immovable)
@@ -47,21 +53,25 @@ namespace lite
     //  can be used to put a body to sleep.
     float motion = 0;
 
-    // Angular orientation of the rigid body in world space.
-    Vector orientation = { 0, 0, 0, 1 };
+    // Slot in the PoseArray holding the orientation and position of the rigid
+    //  body in world space. May be shared with the owning object's Transform.
+    uint32_t pose;
 
-    // Position of the rigid body in world space.
-    Vector position = { 0, 0, 0 };
+    // The pose's Version when the body last picked up a write made to it
+    //  outside of physics.
+    uint32_t poseVersion = 0;
 
     // Used for converting from local to world space and back.
-    float4x4 transformMatrix;
+    RigidTransform transform;
 
     // Velocity of the rigid body in world space.
     Vector velocity = { 0, 0, 0 };
 
   public: // data
 
-    // Functions which add in a force or otherwise act on the rigid body.
+    // Functions which add in a force or otherwise act on the rigid body. Prefer
+    //  a ForceField for anything affecting many bodies; actors are meant for
+    //  rare custom behavior.
     vector<function<void(PhysicsRigidBody& body, float dt)>> Actors;
 
     // The amount of damping applied to angular motion. Damping is required
@@ -72,6 +82,14 @@ namespace lite
     //  for example, should be always awake.
     bool CanSleep = true;
 
+    // Disabled bodies are left out of force fields and integration, which
+    //  is how the bodies of inactive objects are parked.
+    bool Enabled = true;
+
+    // Bitmask of the layers this body belongs to. Force fields only
+    //  affect bodies sharing a layer with the field's mask.
+    uint32_t Layers = 1;
+
     // The amount of damping applied to linear motion. Damping is required to
     //  remove energy added through numerical instability.
     float LinearDamping = 0.999f;
@@ -84,9 +102,15 @@ namespace lite
     // Summation of forces currently acting on this object.
     Vector AccumulatedForces() const { return accumulatedForces; }
 
+    // Summation of torque currently acting on this object.
+    Vector AccumulatedTorque() const { return accumulatedTorque; }
+
     // Amount that the rigid body is rotating in world space.
     Vector AngularVelocity() const { return angularVelocity; }
 
+    // Index of the body in the physics world's array of bodies.
+    const uint32_t& Index() const { return index; }
+
     const float4x4& InverseInertiaTensorWorld() const { return inverseInertiaTensorWorld; }
 
     // 1 / Mass.
@@ -100,19 +124,35 @@ namespace lite
     // Mass in kilograms.
     float Mass() const { return inverseMass == 0 ? numeric_limits<float>::max() : 1.0f / inverseMass; }
 
-    const Vector& Orientation() const { return orientation; }
+    Vector Orientation() const { return PoseArray::Instance()[pose].Rotation; }
 
     // Position in meters.
-    const Vector& Position() const { return position; }
+    Vector Position() const { return PoseArray::Instance()[pose].Position; }
+
+    // Slot in the PoseArray holding the body's pose.
+    const uint32_t& PoseIndex() const { return pose; }
 
-    // Orientation in world space.
-    const float4x4& Transform() const { return transformMatrix; }
+    // Orientation and position in world space.
+    const RigidTransform& Transform() const { return transform; }
 
     // Velocity in meters per second.
     const Vector& Velocity() const { return velocity; }
 
   public:
 
+    PhysicsRigidBody() :
+      pose(PoseArray::Instance().Allocate())
+    {}
+
+    // Bodies own a reference to their pose, so they can't be copied.
+    PhysicsRigidBody(const PhysicsRigidBody&) = delete;
+    PhysicsRigidBody& operator=(const PhysicsRigidBody&) = delete;
+
+    ~PhysicsRigidBody()
+    {
+      PoseArray::Instance().Release(pose);
+    }
+
     void AddForce(float3 vector)
     {
       if (!HasFiniteMass()) return;
@@ -144,7 +184,7 @@ namespace lite
 
       // Convert to coordinates relative to center of mass.
       Vector pt = point;
-      pt -= position;
+      pt -= Position();
 
       accumulatedForces = AccumulatedForces() + force;
       accumulatedTorque = pt.Cross(force);
@@ -155,13 +195,13 @@ namespace lite
     // Converts the given point from world space into the body's local space.
     float3 GetPointInLocalSpace(const float3& worldPoint) const
     {
-      return transformMatrix.TransformInverse(worldPoint);
+      return transform.TransformInverse(worldPoint);
     }
 
     // Converts the given point from the body's local space to world space.
     float3 GetPointInWorldSpace(const float3& localPoint) const
     {
-      return Matrix(transformMatrix).Transform(localPoint);
+      return transform.Transform(localPoint);
     }
 
     // True if the mass of the body is not infinite.
@@ -172,8 +212,9 @@ namespace lite
 
     void Initialize(float3 position, float4 rotation)
     {
-      this->position = position;
-      this->orientation = rotation;
+      Pose& p = BodyPose();
+      p.Position = position;
+      p.Rotation = rotation;
     }
 
     void SetMass(float m)
@@ -193,6 +234,8 @@ namespace lite
     friend class Contact;
     friend class ParticleContact;
     friend class Physics;
+    friend class PhysicsRecorder;
+    friend class PhysicsReplay;
     friend class World;
 
     void AddRotation(const float3& deltaRotation)
@@ -213,6 +256,12 @@ namespace lite
       }
     }
 
+    // Returns the body's pose in the PoseArray to be written to.
+    Pose& BodyPose()
+    {
+      return PoseArray::Instance().Modify(pose);
+    }
+
     // Calculates internal data from state data. This should be called after the
     //  body's state is altered directly (it is called automatically during
     //  integration). If you change the body's state and then intend to 
@@ -220,20 +269,18 @@ namespace lite
     //  you can omit this step.
     void CalculateDerivedData()
     {
-      Vector orientationQuaternion;
-      orientationQuaternion = XMQuaternionNormalize(orientationQuaternion.xm);
-
-      // Calculate the transform matrix for the body.
-      Matrix rotation = XMMatrixRotationQuaternion(orientationQuaternion.xm);
-      Matrix translation = XMMatrixTranslationFromVector(Vector(position).xm);
-      transformMatrix = rotation * translation;
+      // Calculate the rigid transform for the body; this also
+      //  normalizes the orientation.
+      Pose& p = BodyPose();
+      transform.Set(p.Rotation, p.Position);
+      p.Rotation = transform.Orientation();
 
       // Calculate the inertia tensor in world space.
       TransformInertiaTensor(
         inverseInertiaTensorWorld, 
-        orientation, 
+        p.Rotation, 
         inverseInertiaTensor, 
-        transformMatrix);
+        transform.ToMatrix());
     }
 
     void ClearAccumulators()
@@ -262,16 +309,77 @@ namespace lite
       angularVelocity = Vector(angularAcceleration) * pow(AngularDamping, dt);
 
       // Update position based on the current velocity.
-      position = Vector(position).AddScaled(Velocity(), dt);
+      Pose& p = BodyPose();
+      p.Position = Vector(p.Position).AddScaled(Velocity(), dt);
 
       // Update angular position.
-      orientation = Vector(orientation).AddScaled(angularVelocity, dt);
+      p.Rotation = Vector(p.Rotation).AddScaled(angularVelocity, dt);
 
       // Normalize the orientation, and update the matrices with the new 
       //  position and orientation.
       CalculateDerivedData();
     }
 
+    // Overwrites the body's constant properties from a plain record.
+    void LoadProperties(const PhysicsBodyProperties& properties)
+    {
+      AngularDamping = properties.AngularDamping;
+      inverseMass = properties.InverseMass;
+      inverseInertiaTensor = float4x4(XMLoadFloat4x4(&properties.InverseInertiaTensor));
+      Layers = properties.Layers;
+      LinearDamping = properties.LinearDamping;
+    }
+
+    // Overwrites the body's simulation state from a plain record.
+    void LoadState(const PhysicsBodyState& state)
+    {
+      isAwake = (state.Flags & PhysicsBodyState::Awake) != 0;
+      CanSleep = (state.Flags & PhysicsBodyState::CanSleep) != 0;
+      Enabled = (state.Flags & PhysicsBodyState::Enabled) != 0;
+      acceleration = state.Acceleration;
+      accumulatedForces = state.AccumulatedForces;
+      accumulatedTorque = state.AccumulatedTorque;
+      angularVelocity = state.AngularVelocity;
+      lastFrameAcceleration = state.LastFrameAcceleration;
+      motion = state.Motion;
+      Pose& p = BodyPose();
+      p.Rotation = state.Orientation;
+      p.Position = state.Position;
+      velocity = state.Velocity;
+
+      CalculateDerivedData();
+    }
+
+    // Copies the body's constant properties into a plain record.
+    void SaveProperties(PhysicsBodyProperties& properties) const
+    {
+      properties.AngularDamping = AngularDamping;
+      properties.InverseMass = inverseMass;
+      properties.InverseInertiaTensor = inverseInertiaTensor;
+      properties.Layers = Layers;
+      properties.LinearDamping = LinearDamping;
+    }
+
+    // Copies the body's simulation state into a plain record.
+    void SaveState(PhysicsBodyState& state) const
+    {
+      state.Index = index;
+      state.Flags = 
+        (isAwake ? PhysicsBodyState::Awake : 0) | 
+        (CanSleep ? PhysicsBodyState::CanSleep : 0) |
+        (Enabled ? PhysicsBodyState::Enabled : 0);
+      state.Acceleration = acceleration;
+      state.AccumulatedForces = accumulatedForces;
+      state.AccumulatedTorque = accumulatedTorque;
+      state.AngularVelocity = angularVelocity;
+      state.LastFrameAcceleration = lastFrameAcceleration;
+      state.Motion = motion;
+      const Pose& p = PoseArray::Instance()[pose];
+      state.Orientation = p.Rotation;
+      state.Position = p.Position;
+      state.Velocity = velocity;
+    }
+
     void SetAwake(bool awake)
     {
       if (awake)
@@ -296,12 +404,45 @@ namespace lite
 
     void SetOrientation(const Vector& q)
     {
-      orientation = XMQuaternionNormalize(q.xm);
+      BodyPose().Rotation = Vector(XMQuaternionNormalize(q.xm));
     }
 
     void SetPosition(const float3& position)
     {
-      this->position = position;
+      BodyPose().Position = position;
+    }
+
+    // Picks up a pose written outside of physics, e.g. by a Transform
+    //  sharing it: recomputes the derived data and wakes the body, since
+    //  neither happens until it integrates. Returns whether it changed.
+    bool PickUpPoseChange()
+    {
+      uint32_t version = PoseArray::Instance().Version(pose);
+      if (version == poseVersion) return false;
+
+      poseVersion = version;
+      CalculateDerivedData();
+      if (Enabled)
+      {
+        SetAwake(true);
+      }
+      return true;
+    }
+
+    // Makes the body read and write its pose in another slot of the
+    //  PoseArray, such as the one of a Transform, instead of its own.
+    void SharePose(uint32_t index)
+    {
+      if (index == pose) return;
+
+      PoseArray& poses = PoseArray::Instance();
+      poses.Retain(index);
+      poses.Release(pose);
+      pose = index;
+
+      // The slot already holds a pose the body hasn't seen.
+      poseVersion = poses.Version(index);
+      CalculateDerivedData();
     }
 
     // Internal function to do an inertia tensor transform by a quaternion.
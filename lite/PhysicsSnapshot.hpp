@@ -0,0 +1,220 @@
+#pragma once
+
+#include "D3DInclude.hpp"
+#include "Essentials.hpp"
+
+namespace lite
+{
+  // Plain copy of the properties of a rigid body which stay
+  //  constant while it is simulated, such as its mass.
+  struct PhysicsBodyProperties
+  {
+    float      AngularDamping;
+    float      InverseMass;
+    XMFLOAT4X4 InverseInertiaTensor;
+    uint32_t   Layers;
+    float      LinearDamping;
+  };
+
+  // Plain copy of everything that changes while a rigid body is simulated.
+  //  Contains no pointers or padding, so it can be copied and compared bytewise.
+  struct PhysicsBodyState
+  {
+    // Flags stored in PhysicsBodyState::Flags.
+    enum StateFlags : uint32_t
+    {
+      Awake     = 0x1,
+      CanSleep  = 0x2,
+      Enabled   = 0x4
+    };
+
+    // Index of the body in the physics world.
+    uint32_t Index;
+
+    // Combination of StateFlags.
+    uint32_t Flags;
+
+    float3 Acceleration;
+    float3 AccumulatedForces;
+    float3 AccumulatedTorque;
+    float3 AngularVelocity;
+    float3 LastFrameAcceleration;
+    float  Motion;
+    float4 Orientation;
+    float3 Position;
+    float3 Velocity;
+  };
+
+  // Plain copy of a contact from the last simulation step. Bodies
+  //  are referred to by their index in the physics world.
+  struct PhysicsContactState
+  {
+    // Index used when a contact has no second body.
+    static const uint32_t NoBody = ~0U;
+
+    uint32_t Body[2];
+    float3   ContactNormal;
+    float3   ContactPoint;
+    float    Friction;
+    float    Penetration;
+    float    Restitution;
+  };
+
+  // A saved copy of the physics world stored in a single contiguous buffer:
+  //  a header, followed by the contacts, followed by the body records. A full
+  //  snapshot stores every body; a delta snapshot only stores the bodies which
+  //  differ from a baseline snapshot.
+  class PhysicsSnapshot
+  {
+  public: // types
+
+    struct Header
+    {
+      // Number of bodies in the world when the snapshot was taken.
+      uint32_t BodyCount;
+
+      // Numbering of the bodies when the snapshot was taken. Physics changes
+      //  it whenever removing bodies renumbers the rest, so a snapshot is
+      //  never restored onto different bodies with the same indices.
+      uint32_t BodyLayout;
+
+      // Number of body records stored in the snapshot.
+      uint32_t StoredBodies;
+
+      // Number of contact records stored in the snapshot.
+      uint32_t ContactCount;
+
+      // Non-zero if only bodies changed since a baseline are stored.
+      uint32_t IsDelta;
+    };
+
+  private: // data
+
+    vector<uint8_t> data;
+
+  public: // properties
+
+    // Stored body records.
+    const PhysicsBodyState* Bodies() const 
+    { 
+      return reinterpret_cast<const PhysicsBodyState*>(Contacts() + GetHeader().ContactCount);
+    }
+
+    // Stored contact records.
+    const PhysicsContactState* Contacts() const 
+    { 
+      return reinterpret_cast<const PhysicsContactState*>(data.data() + sizeof(Header)); 
+    }
+
+    // Pointer to the contiguous snapshot data.
+    const void* Data() const { return data.data(); }
+
+    // Header describing the contents of the snapshot. (All zero when empty)
+    const Header& GetHeader() const 
+    { 
+      static const Header none = {};
+      return data.empty() ? none : *reinterpret_cast<const Header*>(data.data()); 
+    }
+
+    // Whether the snapshot contains any data.
+    bool IsEmpty() const { return data.empty(); }
+
+    // Whether only bodies changed since a baseline are stored.
+    bool IsDelta() const { return GetHeader().IsDelta != 0; }
+
+    // Size of the snapshot data in bytes.
+    size_t Size() const { return data.size(); }
+
+  public: // methods
+
+    // Copies the snapshot from a raw buffer, e.g. one received over the
+    //  network. The buffer is checked against its header and every body index
+    //  against the header's body count; returns false and leaves the snapshot
+    //  empty if the buffer is malformed.
+    bool Assign(const void* buffer, size_t size)
+    {
+      data.clear();
+      if (size < sizeof(Header)) return false;
+
+      Header header;
+      memcpy(&header, buffer, sizeof(Header));
+      uint64_t expectedSize =
+        sizeof(Header) +
+        uint64_t(header.ContactCount) * sizeof(PhysicsContactState) +
+        uint64_t(header.StoredBodies) * sizeof(PhysicsBodyState);
+      if (size != expectedSize) return false;
+      if (header.StoredBodies > header.BodyCount) return false;
+      if (!header.IsDelta && header.StoredBodies != header.BodyCount) return false;
+
+      auto bytes = static_cast<const uint8_t*>(buffer);
+      data.assign(bytes, bytes + size);
+
+      for (uint32_t i = 0; i < header.StoredBodies; ++i)
+      {
+        if (Bodies()[i].Index >= header.BodyCount)
+        {
+          data.clear();
+          return false;
+        }
+      }
+      for (uint32_t i = 0; i < header.ContactCount; ++i)
+      {
+        for (uint32_t body : Contacts()[i].Body)
+        {
+          if (body != PhysicsContactState::NoBody && body >= header.BodyCount)
+          {
+            data.clear();
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+  private: // methods
+
+    friend class Physics;
+
+    // Resizes the buffer to fit the given number of records. The buffer's
+    //  memory is reused between snapshots, so steady-state use won't allocate.
+    void Reset(uint32_t bodyCount, uint32_t bodyLayout, uint32_t storedBodies, uint32_t contactCount, bool isDelta)
+    {
+      data.resize(
+        sizeof(Header) + 
+        contactCount * sizeof(PhysicsContactState) + 
+        storedBodies * sizeof(PhysicsBodyState));
+
+      Header& header = MutableHeader();
+      header.BodyCount = bodyCount;
+      header.BodyLayout = bodyLayout;
+      header.StoredBodies = storedBodies;
+      header.ContactCount = contactCount;
+      header.IsDelta = isDelta;
+    }
+
+    // Drops body records past the given count.
+    void TrimBodies(uint32_t storedBodies)
+    {
+      MutableHeader().StoredBodies = storedBodies;
+      data.resize(
+        sizeof(Header) + 
+        GetHeader().ContactCount * sizeof(PhysicsContactState) + 
+        storedBodies * sizeof(PhysicsBodyState));
+    }
+
+    PhysicsBodyState* MutableBodies()
+    {
+      return const_cast<PhysicsBodyState*>(Bodies());
+    }
+
+    PhysicsContactState* MutableContacts()
+    {
+      return const_cast<PhysicsContactState*>(Contacts());
+    }
+
+    Header& MutableHeader()
+    {
+      return *reinterpret_cast<Header*>(data.data());
+    }
+  };
+} // namespace lite
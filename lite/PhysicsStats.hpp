@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "Reflection.hpp"
+
+namespace lite
+{
+  // Timings and counters gathered during one simulation iteration (substep).
+  struct PhysicsStepStats
+  {
+    // Milliseconds spent applying forces and integrating bodies.
+    float IntegrateTime = 0;
+
+    // Milliseconds spent preparing primitives and finding candidate pairs.
+    float BroadphaseTime = 0;
+
+    // Milliseconds spent generating, reducing and budgeting contacts.
+    float NarrowphaseTime = 0;
+
+    // Milliseconds spent resolving interpenetration.
+    float PositionSolveTime = 0;
+
+    // Milliseconds spent resolving contact velocities.
+    float VelocitySolveTime = 0;
+
+    // Number of times the contact or pair arrays had to grow.
+    size_t Allocations = 0;
+
+    // Number of bodies awake after integration.
+    size_t AwakeBodies = 0;
+
+    // Number of contacts sent to the resolver.
+    size_t Contacts = 0;
+
+    // Number of candidate pairs sent to the narrowphase.
+    size_t Pairs = 0;
+
+    // Iterations the resolver spent on interpenetration.
+    size_t PositionIterations = 0;
+
+    // Iterations the resolver spent on velocities.
+    size_t VelocityIterations = 0;
+  };
+
+  // Statistics gathered during the most recent Physics::Update.
+  class PhysicsStats
+  {
+  private: // data
+
+    vector<PhysicsStepStats> steps;
+    PhysicsStepStats totals;
+
+  public: // properties
+
+    // Statistics for each simulation iteration of the last update.
+    const vector<PhysicsStepStats>& Steps() const { return steps; }
+
+    // Sums of all simulation iterations of the last update.
+    const PhysicsStepStats& Totals() const { return totals; }
+
+    float IntegrateTime() const       { return totals.IntegrateTime; }
+    float BroadphaseTime() const      { return totals.BroadphaseTime; }
+    float NarrowphaseTime() const     { return totals.NarrowphaseTime; }
+    float PositionSolveTime() const   { return totals.PositionSolveTime; }
+    float VelocitySolveTime() const   { return totals.VelocitySolveTime; }
+    size_t Allocations() const        { return totals.Allocations; }
+    size_t AwakeBodies() const        { return totals.AwakeBodies; }
+    size_t Contacts() const           { return totals.Contacts; }
+    size_t Pairs() const              { return totals.Pairs; }
+    size_t PositionIterations() const { return totals.PositionIterations; }
+    size_t VelocityIterations() const { return totals.VelocityIterations; }
+
+    // Total milliseconds spent in the last update.
+    float TotalTime() const
+    {
+      return 
+        totals.IntegrateTime + 
+        totals.BroadphaseTime + 
+        totals.NarrowphaseTime + 
+        totals.PositionSolveTime + 
+        totals.VelocitySolveTime;
+    }
+
+  public: // methods
+
+    // Writes the column names matching WriteCsv.
+    static ostream& WriteCsvHeader(ostream& os)
+    {
+      return os << 
+        "Update,Step,IntegrateMs,BroadphaseMs,NarrowphaseMs,PositionSolveMs,VelocitySolveMs,"
+        "Pairs,Contacts,PositionIterations,VelocityIterations,AwakeBodies,Allocations\n";
+    }
+
+    // Writes one line per simulation iteration of the last update.
+    ostream& WriteCsv(ostream& os, size_t update) const
+    {
+      for (size_t i = 0; i < steps.size(); ++i)
+      {
+        const PhysicsStepStats& s = steps[i];
+        os << update << "," << i << "," <<
+          s.IntegrateTime << "," << s.BroadphaseTime << "," << s.NarrowphaseTime << "," <<
+          s.PositionSolveTime << "," << s.VelocitySolveTime << "," <<
+          s.Pairs << "," << s.Contacts << "," << 
+          s.PositionIterations << "," << s.VelocityIterations << "," <<
+          s.AwakeBodies << "," << s.Allocations << "\n";
+      }
+      return os;
+    }
+
+  private: // methods
+
+    friend class Physics;
+
+    // Clears all statistics in preparation for a new update.
+    void Begin(size_t stepCount)
+    {
+      steps.assign(stepCount, PhysicsStepStats());
+      totals = PhysicsStepStats();
+    }
+
+    // Sums the statistics of all steps.
+    void End()
+    {
+      for (const PhysicsStepStats& s : steps)
+      {
+        totals.IntegrateTime += s.IntegrateTime;
+        totals.BroadphaseTime += s.BroadphaseTime;
+        totals.NarrowphaseTime += s.NarrowphaseTime;
+        totals.PositionSolveTime += s.PositionSolveTime;
+        totals.VelocitySolveTime += s.VelocitySolveTime;
+        totals.Allocations += s.Allocations;
+        totals.Contacts += s.Contacts;
+        totals.Pairs += s.Pairs;
+        totals.PositionIterations += s.PositionIterations;
+        totals.VelocityIterations += s.VelocityIterations;
+      }
+
+      // Awake bodies is a count, not a sum: use the final step.
+      if (steps.size())
+      {
+        totals.AwakeBodies = steps.back().AwakeBodies;
+      }
+    }
+  };
+
+  // Bind PhysicsStats to reflection.
+  template<>
+  struct Binding<PhysicsStats> : BindingBase<PhysicsStats>
+  {
+    Binding()
+    {
+      Bind(
+        "Allocations", &T::Allocations, ReadOnly,
+        "AwakeBodies", &T::AwakeBodies, ReadOnly,
+        "BroadphaseTime", &T::BroadphaseTime, ReadOnly,
+        "Contacts", &T::Contacts, ReadOnly,
+        "IntegrateTime", &T::IntegrateTime, ReadOnly,
+        "NarrowphaseTime", &T::NarrowphaseTime, ReadOnly,
+        "Pairs", &T::Pairs, ReadOnly,
+        "PositionIterations", &T::PositionIterations, ReadOnly,
+        "PositionSolveTime", &T::PositionSolveTime, ReadOnly,
+        "TotalTime", &T::TotalTime, ReadOnly,
+        "VelocityIterations", &T::VelocityIterations, ReadOnly,
+        "VelocitySolveTime", &T::VelocitySolveTime, ReadOnly);
+    }
+  };
+} // namespace lite
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "D3DInclude.hpp"
+#include "Essentials.hpp"
+
+namespace lite
+{
+  // Position and rotation of an object.
+  struct Pose
+  {
+    // Rotation as a quaternion.
+    float4 Rotation = { 0, 0, 0, 1 };
+
+    // Position x, y, and z.
+    float3 Position = { 0, 0, 0 };
+  };
+
+  // Storage for every pose in the game, shared between systems. A Transform
+  //  and a rigid body can refer to the same slot so physics writes straight
+  //  into the object's pose without copying. Poses are referred to by index
+  //  since the array may move when it grows; slots are reference counted and
+  //  recycled once no one refers to them anymore.
+  //
+  //  Writes made through Modify flag the slot as dirty, which is how the
+  //  TransformHierarchy learns that physics moved an object. The other way
+  //  around, a Transform counts its writes with MarkChanged, which is how a
+  //  rigid body learns that game logic moved it.
+  class PoseArray : public Singleton<PoseArray>
+  {
+  private: // data
+
+    vector<uint8_t>  dirty;
+    vector<uint32_t> freeSlots;
+    vector<Pose>     poses;
+    vector<uint32_t> references;
+    vector<uint32_t> versions;
+
+  public: // properties
+
+    // Number of slots, including free ones.
+    size_t Size() const { return poses.size(); }
+
+  public: // methods
+
+    Pose& operator[](uint32_t index)
+    {
+      return poses[index];
+    }
+
+    const Pose& operator[](uint32_t index) const
+    {
+      return poses[index];
+    }
+
+    // Creates a new pose with a single reference and returns its index.
+    uint32_t Allocate(const Pose& pose = Pose())
+    {
+      // Reuse a free slot if there is one.
+      if (freeSlots.size())
+      {
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        dirty[index] = true;
+        poses[index] = pose;
+        references[index] = 1;
+        versions[index] = 0;
+        return index;
+      }
+
+      dirty.push_back(true);
+      poses.push_back(pose);
+      references.push_back(1);
+      versions.push_back(0);
+      return uint32_t(poses.size() - 1);
+    }
+
+    // Clears the dirty flag of a pose.
+    void ClearDirty(uint32_t index)
+    {
+      dirty[index] = false;
+    }
+
+    // Whether the pose was written through Modify since its flag was cleared.
+    bool IsDirty(uint32_t index) const
+    {
+      return dirty[index] != 0;
+    }
+
+    // Counts a write made to a pose outside of physics. (see Version)
+    void MarkChanged(uint32_t index)
+    {
+      ++versions[index];
+    }
+
+    // Returns a pose to be written to, flagging it as dirty.
+    Pose& Modify(uint32_t index)
+    {
+      dirty[index] = true;
+      return poses[index];
+    }
+
+    // Removes a reference to a pose, freeing its slot if it was the last one.
+    void Release(uint32_t index)
+    {
+      FatalIf(references[index] == 0, "Releasing a pose which is already free");
+      if (--references[index] == 0)
+      {
+        freeSlots.push_back(index);
+      }
+    }
+
+    // Makes room for 'count' more poses.
+    void Reserve(size_t count)
+    {
+      if (count <= freeSlots.size()) return;
+
+      size_t added = count - freeSlots.size();
+      ReserveMore(dirty, added);
+      ReserveMore(poses, added);
+      ReserveMore(references, added);
+      ReserveMore(versions, added);
+    }
+
+    // Adds a reference to a pose.
+    void Retain(uint32_t index)
+    {
+      ++references[index];
+    }
+
+    // Number of writes made to a pose outside of physics.
+    uint32_t Version(uint32_t index) const
+    {
+      return versions[index];
+    }
+  };
+} // namespace lite
@@ -5,6 +5,7 @@
 #include <bitset>
 #include <chrono>
 #include "D3DInclude.hpp"
+#include <deque>
 #include "Essentials.hpp"
 #include "FmodInclude.hpp"
 #include <fstream>
@@ -26,7 +26,9 @@ namespace lite
         auto prefabFileInfo = PathInfo(prefabFile);
         pair<string, GameObject> newPair = { prefabFileInfo.BaseFilename(), GameObject(false) };
 
-        // Load the prefab into the game object.
+        // Load the prefab into the game object, keeping it out of the
+        //  name and tag indices.
+        newPair.second.Indexed(false);
         newPair.second.LoadFromFile(prefabFileInfo.Filename(), config::Prefabs);
 
         // Insert the pair into the hash-map.
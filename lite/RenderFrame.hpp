@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "float4x4.hpp"
+#include "ModelInstance.hpp"
+
+namespace lite
+{
+  // Everything needed to draw one frame, copied out of the simulation so
+  //  that it can be drawn while the simulation moves on to the next frame.
+  class RenderFrame
+  {
+  private: // types
+
+    // A model shared with the simulation, drawn with its own world matrix.
+    struct SharedModel
+    {
+      shared_ptr<const ModelInstance> Model;
+      float4x4                        Transform;
+    };
+
+  private: // data
+
+    // Copies of one-off models to draw. Entries past 'count' are left over
+    //  from earlier frames and are reused to keep their string buffers.
+    vector<ModelInstance> models;
+    size_t count = 0;
+
+    // Models shared with the simulation; adding one only copies a pointer
+    //  and a matrix. Entries past 'sharedCount' are empty.
+    vector<SharedModel> sharedModels;
+    size_t sharedCount = 0;
+
+  public: // data
+
+    // Camera view projection the frame is drawn with.
+    float4x4 ViewProjection;
+
+  public: // properties
+
+    // Number of models in the frame.
+    size_t Size() const { return count + sharedCount; }
+
+  public: // methods
+
+    // Copies a model into the frame, returning the copy.
+    ModelInstance& Add(const ModelInstance& model)
+    {
+      if (count < models.size())
+      {
+        models[count] = model;
+      }
+      else
+      {
+        models.push_back(model);
+      }
+      return models[count++];
+    }
+
+    // Adds a shared model to the frame, drawn with the given world matrix.
+    //  The simulation must not change the model while the frame holds it.
+    void Add(shared_ptr<const ModelInstance> model, const float4x4& transform)
+    {
+      if (sharedCount == sharedModels.size())
+      {
+        sharedModels.emplace_back();
+      }
+      SharedModel& shared = sharedModels[sharedCount++];
+      shared.Model = move(model);
+      shared.Transform = transform;
+    }
+
+    // Removes all models, keeping their memory for the next frame. Shared
+    //  models are released so the simulation can change them in place.
+    void Clear()
+    {
+      count = 0;
+      for (size_t i = 0; i < sharedCount; ++i)
+      {
+        sharedModels[i].Model = nullptr;
+      }
+      sharedCount = 0;
+    }
+
+    // Draws every model in the frame.
+    void Draw()
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        models[i].Draw();
+      }
+      for (size_t i = 0; i < sharedCount; ++i)
+      {
+        sharedModels[i].Model->Draw(sharedModels[i].Transform);
+      }
+    }
+  };
+} // namespace lite
@@ -12,7 +12,7 @@ namespace lite
   private: // data
 
     shared_ptr<PhysicsRigidBody> body;
-    bool pushedInitialTransform = false;
+    bool sharesTransformPose = false;
 
   public: // data
 
@@ -34,6 +34,13 @@ namespace lite
       Mass(b.Mass());
     }
 
+    // Keeps this component's own body and copies the properties into it.
+    RigidBody& operator=(const RigidBody& b)
+    {
+      Mass(b.Mass());
+      return *this;
+    }
+
     void AddForce(const float3& f) 
     { 
       body->AddForce(f); 
@@ -44,25 +51,40 @@ namespace lite
       primitive.Body = body.get();
     }
 
+    // Makes room in physics for 'count' more rigid bodies.
+    static void ReserveSystems(size_t count)
+    {
+      Physics::CurrentInstance()->ReserveBodies(count);
+    }
+
   private: // methods
 
-    void PullFromSystems() override
+    // Returns the body to the simulation.
+    void Activate() override
     {
-      // Publish physics update to the Transform component.
-      Transform& tfm = OwnerReference()[Transform_];
-      tfm.LocalPosition = body->Position();
-      tfm.LocalRotation = body->Orientation();
+      body->Enabled = true;
+    }
+
+    // Parks the body: it stops moving and is left out of the simulation.
+    void Deactivate() override
+    {
+      body->SetAwake(false);
+      body->Enabled = false;
     }
 
     void PushToSystems() override
     {
-      if (!pushedInitialTransform)
+      // The body's pose is the Transform's local pose, so rather than copying
+      //  it back and forth every frame the body writes into the same slot.
+      if (!sharesTransformPose)
       {
-        Transform& tfm = OwnerReference()[Transform_];
-        body->Initialize(tfm.LocalPosition, tfm.LocalRotation);
-        pushedInitialTransform = true;
+        body->SharePose(OwnerReference()[Transform_].PoseIndex());
+        sharesTransformPose = true;
       }
     }
+
+    // Lets Component see which callbacks are overridden.
+    friend class Component<RigidBody>;
   };
 
   template<>
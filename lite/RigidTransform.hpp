@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace lite
+{
+  // A transformation made of only a rotation and a translation. The rotation
+  //  is kept both as a quaternion and as three cached matrix rows, so points
+  //  can be transformed without building a 4x4 matrix, and the inverse is a
+  //  simple transpose rather than a general matrix inversion.
+  //
+  // Follows the same conventions as Matrix: vectors are rows, and A * B
+  //  applies A first, then B.
+  class RigidTransform
+  {
+  private: // data
+
+    // Rotation as a unit quaternion.
+    Vector orientation = { 0, 0, 0, 1 };
+
+    // Translation applied after the rotation.
+    Vector position = { 0, 0, 0 };
+
+    // Rows of the rotation matrix formed by the orientation.
+    Vector rotation[3];
+
+  public: // properties
+
+    // Rotation as a unit quaternion.
+    const Vector& Orientation() const { return orientation; }
+
+    // Translation applied after the rotation.
+    const Vector& Position() const { return position; }
+
+  public: // methods
+
+    // Initializes to the identity transform.
+    RigidTransform()
+    {
+      rotation[0] = XMVectorSet(1, 0, 0, 0);
+      rotation[1] = XMVectorSet(0, 1, 0, 0);
+      rotation[2] = XMVectorSet(0, 0, 1, 0);
+    }
+
+    // Initializes from a quaternion and a position.
+    RigidTransform(const Vector& orientation_, const Vector& position_)
+    {
+      Set(orientation_, position_);
+    }
+
+    // Initializes from a matrix; any scale in the matrix is discarded.
+    explicit RigidTransform(const Matrix& matrix)
+    {
+      XMVECTOR scale, quat, trans;
+      XMMatrixDecompose(&scale, &quat, &trans, matrix.xm);
+      Set(quat, trans);
+    }
+
+    // Returns a row of the equivalent matrix: 0-2 are the rotated
+    //  axes and 3 is the position. e.g. GetAxisVector(3) returns the position.
+    Vector GetAxisVector(size_t i) const
+    {
+      if (i < 3) return rotation[i];
+      return XMVectorSetW(position.xm, 1);
+    }
+
+    // Returns the inverse transform. Because the rotation is orthonormal
+    //  this is just its transpose, not a general inversion.
+    RigidTransform Inverse() const
+    {
+      RigidTransform result;
+      result.orientation = XMQuaternionConjugate(orientation.xm);
+
+      XMMATRIX m;
+      m.r[0] = rotation[0].xm;
+      m.r[1] = rotation[1].xm;
+      m.r[2] = rotation[2].xm;
+      m.r[3] = XMVectorSet(0, 0, 0, 1);
+
+      XMMATRIX transpose = XMMatrixTranspose(m);
+      result.rotation[0] = transpose.r[0];
+      result.rotation[1] = transpose.r[1];
+      result.rotation[2] = transpose.r[2];
+
+      result.position = -TransformInverseDirection(position);
+      return result;
+    }
+
+    // Sets the rotation and position of the transform.
+    void Set(const Vector& orientation_, const Vector& position_)
+    {
+      orientation = XMQuaternionNormalize(orientation_.xm);
+      position = XMVectorSetW(position_.xm, 0);
+
+      XMMATRIX m = XMMatrixRotationQuaternion(orientation.xm);
+      rotation[0] = m.r[0];
+      rotation[1] = m.r[1];
+      rotation[2] = m.r[2];
+    }
+
+    // Returns the equivalent 4x4 matrix.
+    Matrix ToMatrix() const
+    {
+      XMMATRIX m;
+      m.r[0] = rotation[0].xm;
+      m.r[1] = rotation[1].xm;
+      m.r[2] = rotation[2].xm;
+      m.r[3] = XMVectorSetW(position.xm, 1);
+      return m;
+    }
+
+    // Transforms a point from local space into world space.
+    Vector Transform(const Vector& point) const
+    {
+      return TransformDirection(point) + position;
+    }
+
+    // Rotates a direction from local space into world space.
+    Vector TransformDirection(const Vector& direction) const
+    {
+      XMVECTOR result = XMVectorScale(rotation[0].xm, XMVectorGetX(direction.xm));
+      result = XMVectorMultiplyAdd(XMVectorSplatY(direction.xm), rotation[1].xm, result);
+      result = XMVectorMultiplyAdd(XMVectorSplatZ(direction.xm), rotation[2].xm, result);
+      return result;
+    }
+
+    // Transforms a point from world space into local space.
+    Vector TransformInverse(const Vector& point) const
+    {
+      return TransformInverseDirection(point - position);
+    }
+
+    // Rotates a direction from world space into local space.
+    Vector TransformInverseDirection(const Vector& direction) const
+    {
+      return XMVectorSet(
+        direction.Dot(rotation[0]),
+        direction.Dot(rotation[1]),
+        direction.Dot(rotation[2]),
+        0);
+    }
+
+    // Combines two transforms: the result applies this transform, then 'b'.
+    RigidTransform operator*(const RigidTransform& b) const
+    {
+      RigidTransform result;
+      result.orientation = XMQuaternionMultiply(orientation.xm, b.orientation.xm);
+      result.rotation[0] = b.TransformDirection(rotation[0]);
+      result.rotation[1] = b.TransformDirection(rotation[1]);
+      result.rotation[2] = b.TransformDirection(rotation[2]);
+      result.position = b.Transform(position);
+      return result;
+    }
+  };
+} // namespace lite
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "Essentials.hpp"
+#include "GameObject.hpp"
+#include "JobSystem.hpp"
+#include "Pose.hpp"
+#include "Transform.hpp"
+#include "TypeInfo.hpp"
+
+namespace lite
+{
+  // Structural scene changes recorded from any thread and applied later at
+  //  a sync point on the main thread. Adding, removing and moving objects or
+  //  components changes their parents' vectors and the identifier table, so
+  //  logic running on workers records these changes here instead.
+  //
+  //  Every worker of the job system records into its own buffer, without
+  //  locking. Other threads share one buffer behind a lock. The buffers
+  //  keep their memory from frame to frame.
+  //
+  //  Commands are applied sorted by the 'order' they are recorded with;
+  //  commands with the same order are applied in the order they were
+  //  recorded in. Recording each object's commands with its identifier as
+  //  the order applies them the same way whichever thread ran the object.
+  //  Objects are referred to by identifier, so commands on objects which
+  //  are gone by then are dropped.
+  class SceneCommands : public LightSingleton<SceneCommands>
+  {
+  private: // types
+
+    enum class CommandType
+    {
+      AddComponent,
+      Destroy,
+      RemoveComponent,
+      SetParent,
+      Spawn
+    };
+
+    struct Command
+    {
+      uint64_t          Order;
+      CommandType       Type;
+      // Object the command applies to.
+      uint64_t          Object;
+      // New parent for SetParent.
+      uint64_t          Parent;
+      // Component type for AddComponent and RemoveComponent.
+      const TypeInfo*   Component;
+      // Prefab and pose for Spawn.
+      const GameObject* Prefab;
+      Pose              SpawnPose;
+    };
+
+    struct Buffer
+    {
+      vector<Command> Commands;
+    };
+
+  private: // data
+
+    // One buffer per worker followed by the buffer shared by other threads.
+    vector<unique_ptr<Buffer>> buffers;
+    JobSystem&                 jobs;
+
+    // Commands of every buffer, gathered to be sorted.
+    vector<Command> merged;
+
+    // Guards the shared buffer.
+    mutex sharedLock;
+
+  public: // methods
+
+    // Creates a buffer for every worker of the job system.
+    explicit SceneCommands(JobSystem& jobs_) :
+      jobs(jobs_)
+    {
+      for (size_t i = 0; i <= jobs.ThreadCount(); ++i)
+      {
+        buffers.push_back(make_unique<Buffer>());
+      }
+    }
+
+    SceneCommands(const SceneCommands&) = delete;
+    SceneCommands& operator=(const SceneCommands&) = delete;
+
+    // Records adding a component by type to an object.
+    void AddComponent(uint64_t order, const GameObject& object, const TypeInfo& type)
+    {
+      Command command = Blank(order, CommandType::AddComponent, object);
+      command.Component = &type;
+      Record(command);
+    }
+
+    // Records adding a component to an object.
+    template <class T>
+    void AddComponent(uint64_t order, const GameObject& object)
+    {
+      AddComponent(order, object, TypeOf<T>());
+    }
+
+    // Records destroying an object. (see GameObject::Destroy)
+    void Destroy(uint64_t order, const GameObject& object)
+    {
+      Record(Blank(order, CommandType::Destroy, object));
+    }
+
+    // Applies and clears every recorded command. Called on the main thread
+    //  while no other thread records.
+    void Playback()
+    {
+      for (auto& buffer : buffers)
+      {
+        merged.insert(merged.end(), buffer->Commands.begin(), buffer->Commands.end());
+        buffer->Commands.clear();
+      }
+
+      stable_sort(merged.begin(), merged.end(), [](const Command& a, const Command& b)
+      {
+        return a.Order < b.Order;
+      });
+
+      for (auto& command : merged)
+      {
+        Apply(command);
+      }
+      merged.clear();
+    }
+
+    // Records removing the first component of a type from an object.
+    void RemoveComponent(uint64_t order, const GameObject& object, const TypeInfo& type)
+    {
+      Command command = Blank(order, CommandType::RemoveComponent, object);
+      command.Component = &type;
+      Record(command);
+    }
+
+    // Records removing the first component of a type from an object.
+    template <class T>
+    void RemoveComponent(uint64_t order, const GameObject& object)
+    {
+      RemoveComponent(order, object, TypeOf<T>());
+    }
+
+    // Records moving an object below another object.
+    void SetParent(uint64_t order, const GameObject& object, const GameObject& parent)
+    {
+      Command command = Blank(order, CommandType::SetParent, object);
+      command.Parent = parent.Identifier();
+      Record(command);
+    }
+
+    // Records adding a copy of a prefab below an object, placed at a pose.
+    //  The prefab must stay alive until the commands are played back.
+    void Spawn(uint64_t order, const GameObject& parent, const GameObject& prefab, const Pose& pose = Pose())
+    {
+      Command command = Blank(order, CommandType::Spawn, parent);
+      command.Prefab = &prefab;
+      command.SpawnPose = pose;
+      Record(command);
+    }
+
+  private: // methods
+
+    // Applies a command to the scene.
+    static void Apply(const Command& command)
+    {
+      GameObject* object = GameObject::FindByIdentifier(command.Object);
+      if (!object) return;
+
+      switch (command.Type)
+      {
+      case CommandType::AddComponent:
+        object->AddComponent(command.Component->Name);
+        break;
+
+      case CommandType::Destroy:
+        object->Destroy();
+        break;
+
+      case CommandType::RemoveComponent:
+        object->RemoveComponent(command.Component->Name);
+        break;
+
+      case CommandType::SetParent:
+        // Objects already on their way out stay with their parents.
+        if (GameObject* parent = GameObject::FindByIdentifier(command.Parent))
+        {
+          if (!object->DestroyFlag() && !parent->DestroyFlag())
+          {
+            object->SetParent(*parent);
+          }
+        }
+        break;
+
+      case CommandType::Spawn:
+      {
+        GameObject& child = object->AddChild(*command.Prefab);
+        if (Transform* transform = child.GetComponent<Transform>())
+        {
+          transform->SetLocalPosition(command.SpawnPose.Position);
+          transform->SetLocalRotation(command.SpawnPose.Rotation);
+        }
+        break;
+      }
+      }
+    }
+
+    // Returns a command with only the common fields filled in.
+    static Command Blank(uint64_t order, CommandType type, const GameObject& object)
+    {
+      Command command;
+      command.Order = order;
+      command.Type = type;
+      command.Object = object.Identifier();
+      command.Parent = 0;
+      command.Component = nullptr;
+      command.Prefab = nullptr;
+      return command;
+    }
+
+    // Appends a command to the calling thread's buffer.
+    void Record(const Command& command)
+    {
+      size_t index = jobs.ThreadIndex();
+      if (index < jobs.ThreadCount())
+      {
+        buffers[index]->Commands.push_back(command);
+      }
+      else
+      {
+        lock_guard<mutex> guard(sharedLock);
+        buffers[index]->Commands.push_back(command);
+      }
+    }
+  };
+} // namespace lite
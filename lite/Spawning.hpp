@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ComponentPool.hpp"
+#include "Essentials.hpp"
+#include "GameObject.hpp"
+#include "Pose.hpp"
+#include "Transform.hpp"
+
+namespace lite
+{
+  // A prefab flattened into a list of objects, each referring to its parent
+  //  by position in the list, along with the number of components of each
+  //  type it holds. Instantiating the plan many times reserves pools and
+  //  system resources for the whole batch up front, then builds the copies
+  //  without recursion or searching the prefab again.
+  class InstantiationPlan
+  {
+  private: // types
+
+    // An object of the prefab and the position of its parent in the plan.
+    struct Node
+    {
+      const GameObject* Source;
+      uint32_t          Parent;
+    };
+
+    // Parent of the prefab's root object.
+    static const uint32_t NoParent = ~0U;
+
+  private: // data
+
+    // Number of components per pool in one copy of the prefab.
+    vector<pair<IComponentPool*, size_t>> componentCounts;
+
+    // Objects in the prefab, parents before their children.
+    vector<Node> nodes;
+
+    // Objects created for the copy being built, by position in 'nodes'.
+    vector<GameObject*> created;
+
+  public: // properties
+
+    // Number of objects in one copy of the prefab.
+    size_t Size() const { return nodes.size(); }
+
+  public: // methods
+
+    explicit InstantiationPlan(const GameObject& prefab)
+    {
+      Add(prefab, NoParent);
+      created.resize(nodes.size());
+    }
+
+    // Adds 'count' copies of the prefab as children of 'parent', initialized
+    //  and placed at the given poses (if not null). The copies are stored
+    //  consecutively; returns the index of the first in parent's children.
+    size_t Instantiate(GameObject& parent, size_t count, const Pose* poses = nullptr)
+    {
+      size_t first = parent.children.size();
+      if (count == 0) return first;
+
+      // Make room for the whole batch at once.
+      ReserveMore(parent.children, count);
+      for (auto& componentCount : componentCounts)
+      {
+        componentCount.first->Reserve(componentCount.second * count);
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        // Build the copy's objects, each below the copy of its parent.
+        for (size_t n = 0; n < nodes.size(); ++n)
+        {
+          const Node& node = nodes[n];
+          GameObject& owner = node.Parent == NoParent ? parent : *created[node.Parent];
+          GameObject& object = owner.StoreChild(make_unique<GameObject>());
+          if (!node.Source->isNameGenerated)
+          {
+            object.Name(node.Source->name);
+          }
+          object.Tag(node.Source->tag);
+          object.children.reserve(node.Source->children.size());
+
+          for (auto& component : node.Source->components)
+          {
+            object.StoreComponent(component->Clone());
+          }
+          created[n] = &object;
+        }
+
+        GameObject& root = *created[0];
+        if (poses)
+        {
+          if (Transform* transform = root.GetComponent<Transform>())
+          {
+            transform->SetLocalPosition(poses[i].Position);
+            transform->SetLocalRotation(poses[i].Rotation);
+          }
+        }
+        root.Initialize();
+      }
+
+      return first;
+    }
+
+  private: // methods
+
+    // Adds an object and everything below it to the plan.
+    void Add(const GameObject& object, uint32_t parent)
+    {
+      uint32_t index = uint32_t(nodes.size());
+      Node node = { &object, parent };
+      nodes.push_back(node);
+
+      for (auto& component : object.components)
+      {
+        IComponentPool* pool = component.Pool();
+        auto it = find_if(componentCounts.begin(), componentCounts.end(),
+          [=](const pair<IComponentPool*, size_t>& count) { return count.first == pool; });
+
+        if (it == componentCounts.end()) componentCounts.emplace_back(pool, 1);
+        else                             ++it->second;
+      }
+
+      for (auto& child : object.children)
+      {
+        Add(*child, index);
+      }
+    }
+  };
+
+  // Adds 'count' copies of a prefab as children of 'parent' in one batch,
+  //  placed at the given poses (if not null). Returns the index of the first
+  //  copy in parent's children; the copies are consecutive. To spawn the
+  //  same prefab repeatedly, keep an InstantiationPlan instead.
+  inline size_t SpawnMany(GameObject& parent, const GameObject& prefab, size_t count, const Pose* poses = nullptr)
+  {
+    return InstantiationPlan(prefab).Instantiate(parent, count, poses);
+  }
+} // namespace lite
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Component.hpp"
+#include "GameObject.hpp"
+#include "Transform.hpp"
+#include "UpdateScheduler.hpp"
+
+namespace lite
+{
+  // Rocks the object from side to side about its local z axis, as in wind.
+  //  Far away it updates less often. (see UpdateScheduler)
+  class Sway : public Component<Sway>
+  {
+  private: // data
+
+    float amplitude = 0.1f;
+    float frequency = 0.5f;
+
+    // Position in the cycle, in radians.
+    float phase = 0;
+
+    // The object's rotation before swaying.
+    float4 restRotation = { 0, 0, 0, 1 };
+
+    UpdateRate updateRate;
+
+  public: // properties
+
+    // Largest angle swayed to either side, in radians.
+    const float& Amplitude() const { return amplitude; }
+    void Amplitude(float a) { amplitude = a; }
+
+    // Cycles per second.
+    const float& Frequency() const { return frequency; }
+    void Frequency(float f) { frequency = f; }
+
+    // Update rate tier to always use, or -1 to pick it by distance.
+    const int& UpdateTier() const { return updateRate.FixedTier; }
+    void UpdateTier(int tier) { updateRate.FixedTier = tier; }
+
+  public: // methods
+
+    Sway()
+    {}
+
+    // Keeps the cycle of this component.
+    Sway& operator=(const Sway& b)
+    {
+      amplitude = b.amplitude;
+      frequency = b.frequency;
+      updateRate = b.updateRate;
+      return *this;
+    }
+
+  private: // methods
+
+    // Takes the rotation set up by the object as the one to sway about.
+    void Initialize() override
+    {
+      restRotation = OwnerReference()[Transform_].GetLocalRotation();
+    }
+
+    void Update() override
+    {
+      float dt;
+      if (!updateRate.Tick(OwnerReference(), dt)) return;
+
+      phase = fmod(phase + dt * frequency * XM_2PI, XM_2PI);
+      XMVECTOR sway = XMQuaternionRotationRollPitchYaw(0, 0, amplitude * sin(phase));
+
+      float4 rotation;
+      XMStoreFloat4(&rotation, XMQuaternionMultiply(sway, XMLoadFloat4(&restRotation)));
+      OwnerReference()[Transform_].SetLocalRotation(rotation);
+    }
+
+    // Lets Component see which callbacks are overridden.
+    friend class Component<Sway>;
+  };
+
+  template<>
+  struct Binding<Sway> : BindingBase<Sway>
+  {
+    Binding()
+    {
+      Bind(
+        "Amplitude", Const(&T::Amplitude), NonConst(&T::Amplitude),
+        "Frequency", Const(&T::Frequency), NonConst(&T::Frequency),
+        "UpdateTier", Const(&T::UpdateTier), NonConst(&T::UpdateTier));
+    }
+  };
+} // namespace lite
@@ -4,53 +4,130 @@
 #include "Essentials.hpp"
 #include "float4x4.hpp"
 #include "GameObject.hpp"
+#include "Pose.hpp"
 
 namespace lite
 {
+  class Transform;
+
+  // Flattened hierarchy holding transforms, told when one of them is
+  //  destroyed so that it never keeps a dangling pointer.
+  class ITransformHierarchy
+  {
+  public: // methods
+
+    virtual ~ITransformHierarchy() {}
+
+    // Takes a transform out of the hierarchy.
+    virtual void Remove(Transform& transform) = 0;
+  };
+
   class Transform : public Component<Transform>
   {
-  public: // data
+  private: // data
 
-    // Position x, y, and z.
-    float3 LocalPosition = { 0, 0, 0 };
+    // Place in the TransformHierarchy: the hierarchy holding this transform
+    //  (or null), the depth and position in that depth, the parent transform
+    //  at the time it was placed, and whether the world matrix changed
+    //  during the current pass.
+    ITransformHierarchy* hierarchy = nullptr;
+    uint32_t             hierarchyLevel = 0;
+    const Transform*     hierarchyParent = nullptr;
+    uint32_t             hierarchySlot = 0;
+    mutable bool         worldChanged = false;
 
-    // Rotation as a quaternion.
-    float4 LocalRotation = { 0, 0, 0, 1 };
+    // Cached matrices, recomputed when flagged as dirty. A change flags this
+    //  transform's local matrix and the world matrices of the whole subtree.
+    mutable float4x4 localMatrix;
+    mutable bool     localDirty = true;
+    mutable float4x4 worldMatrix;
+    mutable bool     worldDirty = true;
+    // Owner's HierarchyVersion when the world matrix was computed. Moving
+    //  this object or one of its parents in the hierarchy changes it.
+    mutable uint32_t worldHierarchyVersion = 0;
+
+    // Slot in the PoseArray holding the local position and rotation. A root
+    //  level rigid body shares this slot to write its pose directly.
+    uint32_t pose;
 
     // Scale factor.
-    float3 LocalScale = { 1, 1, 1 };
+    float3 localScale = { 1, 1, 1 };
+
+    // Incremented on every change made through this class.
+    uint32_t version = 0;
 
   public: // properties
 
-    const float3& GetLocalPosition() const { return LocalPosition; }
-    void SetLocalPosition(const float3& f) { LocalPosition = f; }
+    // When the object has a root level RigidBody, the body shares the pose:
+    //  setting the position or rotation (here or through the methods below)
+    //  moves the body too. It picks the new pose up and wakes at the start
+    //  of the next physics update.
 
-    const float4& GetLocalRotation() const { return LocalRotation; }
-    void SetLocalRotation(const float4& f) { LocalRotation = f; }
+    // Position x, y, and z. Returned by value: the pose array may grow and
+    //  move its slots while the caller still holds the result.
+    float3 GetLocalPosition() const { return PoseArray::Instance()[pose].Position; }
+    void SetLocalPosition(const float3& f) { PoseArray::Instance()[pose].Position = f; MarkPoseChanged(); }
 
-    const float3& GetLocalScale() const { return LocalScale; }
-    void SetLocalScale(const float3& f) { LocalScale = f; }
+    // Rotation as a quaternion.
+    float4 GetLocalRotation() const { return PoseArray::Instance()[pose].Rotation; }
+    void SetLocalRotation(const float4& f) { PoseArray::Instance()[pose].Rotation = f; MarkPoseChanged(); }
+
+    // Scale factor.
+    const float3& GetLocalScale() const { return localScale; }
+    void SetLocalScale(const float3& f) { localScale = f; MarkDirty(); }
+
+    // Slot in the PoseArray holding the local position and rotation.
+    const uint32_t& PoseIndex() const { return pose; }
+
+    // Incremented whenever the transform is changed through its methods. A
+    //  rigid body writing into the shared pose slot doesn't increment it.
+    const uint32_t& Version() const { return version; }
 
   public: // methods
 
-    Transform() = default;
+    Transform() :
+      pose(PoseArray::Instance().Allocate())
+    {}
 
     Transform(const Transform& b) :
-      LocalPosition(b.LocalPosition),
-      LocalRotation(b.LocalRotation),
-      LocalScale(b.LocalScale)
+      pose(PoseArray::Instance().Allocate(PoseArray::Instance()[b.pose])),
+      localScale(b.localScale)
     {}
 
+    // Keeps this transform's own pose slot and copies the pose into it.
+    Transform& operator=(const Transform& b)
+    {
+      PoseArray::Instance()[pose] = PoseArray::Instance()[b.pose];
+      localScale = b.localScale;
+      MarkPoseChanged();
+      return *this;
+    }
+
+    ~Transform()
+    {
+      if (hierarchy)
+      {
+        hierarchy->Remove(*this);
+      }
+      PoseArray::Instance().Release(pose);
+    }
+
+    // Makes room in the pose array for 'count' more transforms.
+    static void ReserveSystems(size_t count)
+    {
+      PoseArray::Instance().Reserve(count);
+    }
+
     // Transformation formed by this transform only (doesn't include parents).
     XMMATRIX GetLocalMatrix() const
     {
-      return XMMatrixTransformation(
-        XMVectorZero(),                 // center (position) of scaling
-        XMVectorZero(),                 // orientation (rotation) of the scaling
-        XMLoadFloat3(&LocalScale),      // scaling factors
-        XMVectorZero(),                 // center (position) of rotation
-        XMLoadFloat4(&LocalRotation),   // quaternion rotation
-        XMLoadFloat3(&LocalPosition));  // translation
+      ConsumePoseChange();
+      if (localDirty)
+      {
+        localMatrix = ComputeLocalMatrix();
+        localDirty = false;
+      }
+      return XMLoadFloat4x4(&localMatrix);
     }
 
     XMMATRIX GetOffsetFromParent(Transform& parent) const
@@ -61,26 +138,43 @@ namespace lite
       }
 
       // Multiply this local transform with the parent's offset.
-      if (Owner() && Owner()->Parent())
+      const Transform* parentTransform = ParentTransform();
+      if (parentTransform)
       {
-        return OwnerReference().ParentReference()[Transform_].GetOffsetFromParent(parent) * GetLocalMatrix();
+        return parentTransform->GetOffsetFromParent(parent) * GetLocalMatrix();
       }
 
       // No parents: return the local matrix.
       return GetLocalMatrix();
     }
 
-    // Transformation formed by this transform and all of its parents.
+    // Transformation formed by this transform and all of its parents. Usually
+    //  already computed by the TransformHierarchy pass; otherwise only the
+    //  dirty part of the chain of parents is recomputed.
     XMMATRIX GetWorldMatrix() const
     {
-      // Multiply this local transform with the parent's world transform.
-      if (Owner() && Owner()->Parent())
+      // Physics may have moved a transform further up since the last pass,
+      //  which only flags the transforms below it once its pose is seen.
+      for (const Transform* transform = this; transform; transform = transform->ParentTransform())
       {
-        return OwnerReference().ParentReference()[Transform_].GetWorldMatrix() * GetLocalMatrix();
+        transform->ConsumePoseChange();
       }
-    
-      // No parents: return the local matrix.
-      return GetLocalMatrix();
+      return ComputeWorldMatrix();
+    }
+
+    // Returns the transform of the closest parent object which has one.
+    //  (May return null)
+    Transform* ParentTransform() const
+    {
+      for (GameObject* object = Owner() ? Owner()->Parent() : nullptr; object; object = object->Parent())
+      {
+        Transform* transform = object->GetComponent<Transform>();
+        if (transform)
+        {
+          return transform;
+        }
+      }
+      return nullptr;
     }
 
     // Rotate roll (z), then pitch (x), then yaw (y).
@@ -92,22 +186,25 @@ namespace lite
         eulerAngles.y,
         eulerAngles.z);
 
-      // Multiply with the current rotation and store in LocalRotation.
+      // Multiply with the current rotation and store in the pose.
+      float4& rotation = PoseArray::Instance()[pose].Rotation;
       XMStoreFloat4(
-        &LocalRotation, 
+        &rotation, 
         XMQuaternionMultiply(
-          XMLoadFloat4(&LocalRotation), 
+          XMLoadFloat4(&rotation), 
           rot));
+      MarkPoseChanged();
     }
 
     // Multiplies x, y, z components to the current scale.
     void ScaleBy(float3 scaleFactor)
     {
       XMStoreFloat3(
-        &LocalScale, 
+        &localScale, 
         XMVectorMultiply(
-          XMLoadFloat3(&LocalScale), 
+          XMLoadFloat3(&localScale), 
           XMLoadFloat3(&scaleFactor)));
+      MarkDirty();
     }
 
     // Sets local properties to construct the matrix.
@@ -118,19 +215,129 @@ namespace lite
       XMMatrixDecompose(&scale, &quat, &trans, XMLoadFloat4x4(&matrix));
 
       // Save the results.
-      XMStoreFloat3(&LocalScale, scale);
-      XMStoreFloat4(&LocalRotation, quat);
-      XMStoreFloat3(&LocalPosition, trans);
+      Pose& p = PoseArray::Instance()[pose];
+      XMStoreFloat3(&localScale, scale);
+      XMStoreFloat4(&p.Rotation, quat);
+      XMStoreFloat3(&p.Position, trans);
+      MarkPoseChanged();
     }
 
     // Offset position x, y, z.
     void TranslateBy(float3 positionOffset)
     {
+      float3& position = PoseArray::Instance()[pose].Position;
       XMStoreFloat3(
-        &LocalPosition, 
+        &position, 
         XMVectorAdd(
-          XMLoadFloat3(&LocalPosition), 
+          XMLoadFloat3(&position), 
           XMLoadFloat3(&positionOffset)));
+      MarkPoseChanged();
+    }
+
+  private: // methods
+
+    friend class TransformHierarchy;
+
+    XMMATRIX ComputeLocalMatrix() const
+    {
+      const Pose& p = PoseArray::Instance()[pose];
+      return XMMatrixTransformation(
+        XMVectorZero(),                 // center (position) of scaling
+        XMVectorZero(),                 // orientation (rotation) of the scaling
+        XMLoadFloat3(&localScale),      // scaling factors
+        XMVectorZero(),                 // center (position) of rotation
+        XMLoadFloat4(&p.Rotation),      // quaternion rotation
+        XMLoadFloat3(&p.Position));     // translation
+    }
+
+    // Recomputes the world matrix if it or one of its parents' is dirty.
+    XMMATRIX ComputeWorldMatrix() const
+    {
+      if (IsWorldDirty())
+      {
+        // Multiply this local transform with the parent's world transform.
+        const Transform* parentTransform = ParentTransform();
+        worldMatrix = parentTransform ?
+          parentTransform->ComputeWorldMatrix() * GetLocalMatrix() :
+          GetLocalMatrix();
+        worldDirty = false;
+        worldHierarchyVersion = Owner() ? Owner()->HierarchyVersion() : 0;
+      }
+      return XMLoadFloat4x4(&worldMatrix);
+    }
+
+    // Whether the world matrix was flagged as dirty, or this object or one of
+    //  its parents moved in the hierarchy since it was computed.
+    bool IsWorldDirty() const
+    {
+      return worldDirty || (Owner() && Owner()->HierarchyVersion() != worldHierarchyVersion);
+    }
+
+    // Picks up a write made to the pose by physics since it was last seen.
+    void ConsumePoseChange() const
+    {
+      PoseArray& poses = PoseArray::Instance();
+      if (poses.IsDirty(pose))
+      {
+        poses.ClearDirty(pose);
+        localDirty = true;
+        MarkWorldDirty();
+      }
+    }
+
+    // Counts a write to the pose slot, so that a rigid body sharing it picks
+    //  the new pose up, and flags the matrices as dirty.
+    void MarkPoseChanged()
+    {
+      PoseArray::Instance().MarkChanged(pose);
+      MarkDirty();
+    }
+
+    // Flags the local matrix and the world matrices of the subtree as dirty.
+    void MarkDirty()
+    {
+      ++version;
+      localDirty = true;
+      MarkWorldDirty();
+    }
+
+    // Flags the world matrices of this transform and all transforms below it as
+    //  dirty. A dirty transform's subtree is always dirty, so this stops early.
+    //  Moves in the hierarchy are caught by the HierarchyVersion instead.
+    void MarkWorldDirty() const
+    {
+      if (worldDirty) return;
+
+      worldDirty = true;
+      if (Owner())
+      {
+        MarkChildrenDirty(*Owner());
+      }
+    }
+
+    // Objects below the new owner may have been relative to a transform
+    //  further up, so their world matrices need to be recomputed.
+    void SetOwner(GameObject& owner) override
+    {
+      Component<Transform>::SetOwner(owner);
+      MarkChildrenDirty(owner);
+    }
+
+    // Flags the world matrices of the closest transforms below an object.
+    static void MarkChildrenDirty(const GameObject& object)
+    {
+      for (auto& child : object.Children())
+      {
+        Transform* transform = child->GetComponent<Transform>();
+        if (transform)
+        {
+          transform->MarkWorldDirty();
+        }
+        else
+        {
+          MarkChildrenDirty(*child);
+        }
+      }
     }
   };
 
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "chrono.hpp"
+#include "D3DInclude.hpp"
+#include "Essentials.hpp"
+#include "GameObject.hpp"
+#include "Transform.hpp"
+#include "TransformHierarchy.hpp"
+#include "JobSystem.hpp"
+
+namespace lite
+{
+  // Average milliseconds per update of each way of computing world matrices.
+  struct TransformBenchmarkResult
+  {
+    // Number of transforms updated.
+    size_t Transforms = 0;
+
+    // Number of worker threads used by the parallel pass.
+    size_t Threads = 0;
+
+    // Recursively multiplying every ancestor's matrix, as GetWorldMatrix
+    //  used to do for every object every frame.
+    double RecursiveMilliseconds = 0;
+
+    // A TransformHierarchy pass on the calling thread.
+    double SerialMilliseconds = 0;
+
+    // A TransformHierarchy pass split across the JobSystem.
+    double ParallelMilliseconds = 0;
+  };
+
+  namespace detail
+  {
+    // World matrix computed without any caching.
+    inline XMMATRIX RecursiveWorldMatrix(const Transform& transform)
+    {
+      float4 rotation = transform.GetLocalRotation();
+      float3 position = transform.GetLocalPosition();
+      XMMATRIX local = XMMatrixTransformation(
+        XMVectorZero(),
+        XMVectorZero(),
+        XMLoadFloat3(&transform.GetLocalScale()),
+        XMVectorZero(),
+        XMLoadFloat4(&rotation),
+        XMLoadFloat3(&position));
+
+      const Transform* parent = transform.ParentTransform();
+      return parent ? RecursiveWorldMatrix(*parent) * local : local;
+    }
+  } // namespace detail
+
+  // Times world matrix updates for a field of Grass and Tree instances under a
+  //  moving root, with every matrix changing each update. The instances only
+  //  carry the Transforms of the Grass and Tree prefabs so that physics and
+  //  graphics stay out of the measurement. Flagging the subtree as dirty is
+  //  paid when the root moves and isn't timed. The instances get their own
+  //  TransformHierarchy, so the scene's transforms aren't timed with them;
+  //  the parallel pass uses the current JobSystem when it exists.
+  inline TransformBenchmarkResult BenchmarkTransforms(size_t instances = 100000, size_t iterations = 20)
+  {
+    TransformBenchmarkResult result;
+
+    // Build the field of instances under a root object.
+    unique_ptr<GameObject> root = make_unique<GameObject>();
+    root->Name("TransformBenchmark");
+    root->AddComponent<Transform>();
+
+    GameObject grass;
+    grass.Name("Grass");
+    grass.AddComponent<Transform>().SetLocalScale({ 1, 0.3f, 1 });
+
+    GameObject tree;
+    tree.Name("Tree");
+    tree.AddComponent<Transform>();
+
+    vector<Transform*> transforms;
+    transforms.reserve(instances);
+    for (size_t i = 0; i < instances; ++i)
+    {
+      GameObject& object = root->AddChild(i % 2 ? tree : grass, false);
+      Transform& transform = object[Transform_];
+      transform.SetLocalPosition({ float(i % 1000), i % 2 ? 0.0f : -1.0f, float(i / 1000) });
+      transforms.push_back(&transform);
+    }
+    Transform& rootTransform = (*root)[Transform_];
+
+    // Keep the scene's hierarchy current while the benchmark's exists.
+    TransformHierarchy* sceneHierarchy = TransformHierarchy::CurrentInstance();
+    unique_ptr<TransformHierarchy> hierarchy = make_unique<TransformHierarchy>(*root);
+    TransformHierarchy::MakeCurrent(sceneHierarchy);
+
+    // Flatten the hierarchy before timing anything.
+    hierarchy->Update();
+    result.Transforms = hierarchy->Size();
+    result.Threads = JobSystem::CurrentInstance() ? JobSystem::CurrentInstance()->ThreadCount() : 0;
+
+    // Recursive matrices for every instance.
+    aligned_vector<XMMATRIX> sink(instances);
+    high_resolution_timer timer;
+    for (size_t it = 0; it < iterations; ++it)
+    {
+      rootTransform.RotateBy({ 0, 0.01f, 0 });
+      timer.start();
+      for (size_t i = 0; i < instances; ++i)
+      {
+        sink[i] = detail::RecursiveWorldMatrix(*transforms[i]);
+      }
+      result.RecursiveMilliseconds += timer.elapsed_milliseconds();
+    }
+
+    // Hierarchy pass on one thread, then split across the workers.
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+      hierarchy->Parallel = pass == 1;
+      double& milliseconds = pass == 1 ? result.ParallelMilliseconds : result.SerialMilliseconds;
+      for (size_t it = 0; it < iterations; ++it)
+      {
+        rootTransform.RotateBy({ 0, 0.01f, 0 });
+        timer.start();
+        hierarchy->Update();
+        milliseconds += timer.elapsed_milliseconds();
+      }
+    }
+
+    result.RecursiveMilliseconds /= iterations;
+    result.SerialMilliseconds /= iterations;
+    result.ParallelMilliseconds /= iterations;
+    return result;
+  }
+
+  inline ostream& operator<<(ostream& os, const TransformBenchmarkResult& result)
+  {
+    return os << 
+      result.Transforms << " transforms, " << result.Threads << " workers: " <<
+      "recursive " << result.RecursiveMilliseconds << " ms, " <<
+      "serial pass " << result.SerialMilliseconds << " ms, " <<
+      "parallel pass " << result.ParallelMilliseconds << " ms";
+  }
+} // namespace lite
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "ComponentManager.hpp"
+#include "D3DInclude.hpp"
+#include "Essentials.hpp"
+#include "GameObject.hpp"
+#include "Transform.hpp"
+#include "JobSystem.hpp"
+
+namespace lite
+{
+  // Keeps the world matrices of all transforms up to date in a single pass.
+  //  Transforms are grouped by depth, so a parent is always in the level
+  //  before its children: walking the levels in order recomputes each changed
+  //  world matrix exactly once, straight from its parent's matrix computed
+  //  just before. When objects move in the hierarchy only the transforms of
+  //  the moved subtrees are taken out of their levels and placed again, and
+  //  a destroyed transform takes itself out.
+  //
+  //  Transforms of the same depth don't depend on each other, so when a
+  //  JobSystem exists each large enough level is split across its threads.
+  //
+  //  A hierarchy can also keep only the transforms below one root object,
+  //  e.g. to time updates apart from the scene. It isn't told about moved
+  //  objects, so the shape of that subtree must stay fixed, and transforms
+  //  it takes leave the hierarchy which kept them before.
+  class TransformHierarchy : public LightSingleton<TransformHierarchy>, public ITransformHierarchy
+  {
+  private: // data
+
+    // Whether the levels hold every transform yet.
+    bool built = false;
+
+    // Object whose subtree is kept, or null to keep every transform.
+    GameObject* root = nullptr;
+
+    // Number of transforms in all levels.
+    size_t count = 0;
+
+    // Transforms of each depth, in no particular order.
+    vector<vector<Transform*>> levels;
+
+    // Number of world matrices recomputed by the last update.
+    atomic<size_t> recomputed;
+
+    // Scratch arrays reused when placing moved transforms.
+    vector<uint64_t>   moved;
+    vector<Transform*> unplaced;
+
+    // Level being updated, and the job updating part of it.
+    const vector<Transform*>* currentLevel = nullptr;
+    function<void(size_t, size_t)> updateRange;
+
+  public: // data
+
+    // Whether to split levels across the threads of the current JobSystem.
+    bool Parallel = true;
+
+    // Number of transforms a thread takes from a level at a time.
+    size_t ParallelGrain = 1024;
+
+    // Levels with fewer transforms than this are updated on the calling thread.
+    size_t ParallelThreshold = 4096;
+
+  public: // properties
+
+    // Number of levels in the flattened hierarchy.
+    size_t Depth() const { return levels.size(); }
+
+    // Number of world matrices recomputed by the last update.
+    size_t Recomputed() const { return recomputed; }
+
+    // Number of transforms in the flattened hierarchy.
+    size_t Size() const { return count; }
+
+  public: // methods
+
+    TransformHierarchy()
+    {
+      recomputed = 0;
+      updateRange = [this](size_t begin, size_t end) { UpdateRange(*currentLevel, begin, end); };
+    }
+
+    // Keeps only the transforms of 'root' and everything below it. The
+    //  root's world matrix is its local matrix.
+    explicit TransformHierarchy(GameObject& root) :
+      TransformHierarchy()
+    {
+      this->root = &root;
+    }
+
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    ~TransformHierarchy()
+    {
+      for (auto& level : levels)
+      {
+        for (Transform* transform : level)
+        {
+          transform->hierarchy = nullptr;
+        }
+      }
+    }
+
+    // Takes a transform out of its level by swapping the last transform of
+    //  the level into its place.
+    void Remove(Transform& transform) override
+    {
+      vector<Transform*>& level = levels[transform.hierarchyLevel];
+      Transform* last = level.back();
+      level[transform.hierarchySlot] = last;
+      last->hierarchySlot = transform.hierarchySlot;
+      level.pop_back();
+      transform.hierarchy = nullptr;
+      --count;
+
+      // Drop empty levels from the bottom.
+      while (levels.size() && levels.back().empty())
+      {
+        levels.pop_back();
+      }
+    }
+
+    // Recomputes the local and world matrices of every transform which
+    //  changed, either through its methods or by physics moving its pose,
+    //  along with the world matrices of everything below it.
+    void Update()
+    {
+      if (!built)
+      {
+        Build();
+      }
+      else
+      {
+        PlaceMoved();
+      }
+
+      recomputed = 0;
+
+      // Update one level at a time; each level only reads the one before it.
+      JobSystem* jobs = Parallel ? JobSystem::CurrentInstance() : nullptr;
+      for (auto& level : levels)
+      {
+        if (jobs && level.size() >= ParallelThreshold)
+        {
+          currentLevel = &level;
+          jobs->ParallelFor(0, level.size(), ParallelGrain, updateRange);
+        }
+        else
+        {
+          UpdateRange(level, 0, level.size());
+        }
+      }
+      currentLevel = nullptr;
+    }
+
+  private: // methods
+
+    // Places every owned transform the first time the hierarchy is updated.
+    void Build()
+    {
+      if (root)
+      {
+        Unplace(*root);
+        for (Transform* transform : unplaced)
+        {
+          Place(*transform);
+        }
+        unplaced.clear();
+        built = true;
+        return;
+      }
+
+      GameObject::TakeMovedObjects(moved);
+      ComponentManager::Instance().ForEach<Transform>([&](Transform& transform)
+      {
+        if (transform.Owner())
+        {
+          Place(transform);
+        }
+      });
+      built = true;
+    }
+
+    // Places a transform one level below its parent transform, placing the
+    //  parent first if needed. Returns the level of the transform.
+    uint32_t Place(Transform& transform)
+    {
+      if (transform.hierarchy == this)
+      {
+        return transform.hierarchyLevel;
+      }
+
+      // A transform is kept by one hierarchy at a time.
+      if (transform.hierarchy)
+      {
+        transform.hierarchy->Remove(transform);
+      }
+
+      Transform* parent = transform.Owner() != root ? transform.ParentTransform() : nullptr;
+      uint32_t level = parent ? Place(*parent) + 1 : 0;
+      if (level >= levels.size())
+      {
+        levels.resize(level + 1);
+      }
+
+      transform.hierarchy = this;
+      transform.hierarchyLevel = level;
+      transform.hierarchyParent = parent;
+      transform.hierarchySlot = uint32_t(levels[level].size());
+      levels[level].push_back(&transform);
+      ++count;
+
+      // The parent may have changed, so recompute the world matrix once.
+      transform.worldDirty = true;
+      return level;
+    }
+
+    // Takes the transforms of every subtree which moved since the last
+    //  update out of their levels, then places them below their new parents.
+    void PlaceMoved()
+    {
+      if (root) return;
+
+      GameObject::TakeMovedObjects(moved);
+      for (uint64_t id : moved)
+      {
+        GameObject* object = GameObject::FindByIdentifier(id);
+        if (object)
+        {
+          Unplace(*object);
+        }
+      }
+
+      for (Transform* transform : unplaced)
+      {
+        Place(*transform);
+      }
+      unplaced.clear();
+    }
+
+    // Takes the transforms of an object and everything below it out of
+    //  their levels, remembering them to be placed again.
+    void Unplace(GameObject& object)
+    {
+      Transform* transform = object.GetComponent<Transform>();
+      if (transform)
+      {
+        if (transform->hierarchy == this)
+        {
+          Remove(*transform);
+        }
+        unplaced.push_back(transform);
+      }
+
+      for (auto& child : object.Children())
+      {
+        Unplace(*child);
+      }
+    }
+
+    // Updates the matrices of a range of transforms in a level. The parents
+    //  of the whole range must already be up to date.
+    void UpdateRange(const vector<Transform*>& level, size_t begin, size_t end)
+    {
+      PoseArray& poses = PoseArray::Instance();
+      size_t updated = 0;
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        const Transform& transform = *level[i];
+        const Transform* parent = transform.hierarchyParent;
+
+        // Pick up poses written by physics.
+        if (poses.IsDirty(transform.pose))
+        {
+          poses.ClearDirty(transform.pose);
+          transform.localDirty = true;
+        }
+
+        transform.worldChanged = transform.localDirty || transform.worldDirty || (parent && parent->worldChanged);
+        if (!transform.worldChanged) continue;
+
+        if (transform.localDirty)
+        {
+          transform.localMatrix = transform.ComputeLocalMatrix();
+          transform.localDirty = false;
+        }
+
+        // Multiply the local matrix with the parent's world matrix.
+        XMMATRIX local = XMLoadFloat4x4(&transform.localMatrix);
+        transform.worldMatrix = parent ? 
+          XMMatrixMultiply(XMLoadFloat4x4(&parent->worldMatrix), local) : 
+          local;
+        transform.worldDirty = false;
+        transform.worldHierarchyVersion = transform.Owner()->HierarchyVersion();
+        ++updated;
+      }
+
+      recomputed += updated;
+    }
+  };
+} // namespace lite
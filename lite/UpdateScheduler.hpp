@@ -0,0 +1,225 @@
+#pragma once
+
+#include "D3DInclude.hpp"
+#include "Essentials.hpp"
+#include "GameObject.hpp"
+#include "Transform.hpp"
+
+namespace lite
+{
+  // Picks how often components which opt in are updated, by distance from
+  //  a viewpoint (usually the camera) or by a tier fixed by the component.
+  //  Far tiers update every few frames with the time accumulated since the
+  //  last update, so large populations far away cost a fraction per frame.
+  //  Components are spread across the frames of their interval so that a
+  //  tier's updates don't all land on the same frame.
+  //
+  //  Components opt in by holding an UpdateRate and asking it whether to
+  //  update:
+  //
+  //    void Update() override
+  //    {
+  //      float dt;
+  //      if (!updateRate.Tick(OwnerReference(), dt)) return;
+  //      ...
+  //    }
+  class UpdateScheduler : public LightSingleton<UpdateScheduler>
+  {
+  public: // types
+
+    struct Tier
+    {
+      // Objects up to this far from the viewpoint use the tier.
+      float    MaxDistance;
+      // Number of frames between updates.
+      uint32_t Interval;
+    };
+
+    // Updates made in a tier, counted from the second update of each
+    //  component on.
+    struct TierStatistics
+    {
+      uint64_t Updates = 0;
+      // Updates which came later than the tier's interval, e.g. because
+      //  the component was inactive for a while.
+      uint64_t Late = 0;
+    };
+
+  private: // data
+
+    float    deltaTime = 0;
+    double   time = 0;
+    uint64_t frame = 0;
+    uint32_t nextStagger = 0;
+    vector<Tier> tiers;
+    vector<TierStatistics> stats;
+    float3   viewpoint = { 0, 0, 0 };
+
+  public: // properties
+
+    // Time since the previous frame.
+    const float& DeltaTime() const { return deltaTime; }
+
+    // Number of frames begun so far.
+    const uint64_t& Frame() const { return frame; }
+
+    // Statistics per tier, in the order of the tiers.
+    const vector<TierStatistics>& Stats() const { return stats; }
+
+    // Time accumulated over every frame begun so far.
+    const double& Time() const { return time; }
+
+    // Tiers by increasing distance. Objects past the last tier use it.
+    //  Setting them starts the statistics over.
+    const vector<Tier>& Tiers() const { return tiers; }
+    void Tiers(vector<Tier> tiers_)
+    {
+      FatalIf(tiers_.empty(), "UpdateScheduler needs at least one tier");
+      tiers = move(tiers_);
+      stats.assign(tiers.size(), TierStatistics());
+    }
+
+    // Point distances are measured from.
+    const float3& Viewpoint() const { return viewpoint; }
+
+  public: // methods
+
+    // Every frame up close, then every 2nd, 4th and 8th farther out.
+    UpdateScheduler()
+    {
+      Tiers({ { 40, 1 }, { 80, 2 }, { 160, 4 }, { numeric_limits<float>::max(), 8 } });
+    }
+
+    // Starts a frame, before the scene is updated.
+    void BeginFrame(float dt, const float3& viewpoint_)
+    {
+      deltaTime = dt;
+      time += dt;
+      ++frame;
+      viewpoint = viewpoint_;
+    }
+
+    // Returns the tier an object is in. A fixed tier (if not negative) is
+    //  used instead of the object's distance.
+    size_t TierOf(const GameObject& object, int fixedTier) const
+    {
+      if (fixedTier >= 0)
+      {
+        return min(size_t(fixedTier), tiers.size() - 1);
+      }
+
+      // Objects without a transform are treated as close.
+      Transform* transform = const_cast<GameObject&>(object).GetComponent<Transform>();
+      if (!transform) return 0;
+
+      float distanceSquared;
+      XMVECTOR offset = XMVectorSubtract(transform->GetWorldMatrix().r[3], XMLoadFloat3(&viewpoint));
+      XMStoreFloat(&distanceSquared, XMVector3LengthSq(offset));
+
+      for (size_t i = 0; i < tiers.size(); ++i)
+      {
+        if (distanceSquared <= tiers[i].MaxDistance * tiers[i].MaxDistance)
+        {
+          return i;
+        }
+      }
+      return tiers.size() - 1;
+    }
+
+    // Returns a number to offset the next component's updates by.
+    uint32_t NextStagger()
+    {
+      return nextStagger++;
+    }
+
+    // Counts an update of a component scheduled in the given tier, made
+    //  the given number of frames after its previous update.
+    void RecordUpdate(size_t tier, uint64_t frames)
+    {
+      if (tier >= stats.size()) return;
+
+      ++stats[tier].Updates;
+      if (frames > tiers[tier].Interval)
+      {
+        ++stats[tier].Late;
+      }
+    }
+  };
+
+  // Prints the statistics of every tier.
+  inline ostream& operator<<(ostream& os, const UpdateScheduler& scheduler)
+  {
+    os << "Update rates:";
+    for (size_t i = 0; i < scheduler.Tiers().size(); ++i)
+    {
+      const UpdateScheduler::TierStatistics& stats = scheduler.Stats()[i];
+      os << " [every " << scheduler.Tiers()[i].Interval << ": " <<
+        stats.Updates << " updates, " << stats.Late << " late]";
+    }
+    return os;
+  }
+
+  // How often a component updates. (see UpdateScheduler)
+  class UpdateRate
+  {
+  private: // data
+
+    // Frame of the next update, and of the last one with the time then.
+    uint64_t nextFrame = 0;
+    uint64_t lastFrame = 0;
+    double   lastTime = 0;
+
+    // Tier the next update was scheduled by.
+    size_t tier = 0;
+
+  public: // data
+
+    // Tier to always use, e.g. 0 for objects which matter wherever they
+    //  are, or -1 to pick the tier by distance.
+    int FixedTier = -1;
+
+  public: // methods
+
+    UpdateRate() = default;
+
+    // Copies start over with their own stagger.
+    UpdateRate(const UpdateRate& b) :
+      FixedTier(b.FixedTier)
+    {}
+
+    UpdateRate& operator=(const UpdateRate& b)
+    {
+      FixedTier = b.FixedTier;
+      return *this;
+    }
+
+    // Returns whether to update this frame and the time to update by.
+    //  Called once per frame. The tier is chosen again on each update.
+    //  The schedule follows the scheduler's frames, so frames the caller
+    //  missed (while inactive, say) don't push the next update back.
+    bool Tick(const GameObject& owner, float& dt)
+    {
+      UpdateScheduler* scheduler = UpdateScheduler::CurrentInstance();
+      FatalIf(!scheduler, "No UpdateScheduler for components with an UpdateRate");
+
+      uint64_t frame = scheduler->Frame();
+      if (frame < nextFrame) return false;
+
+      // The first update covers only the current frame.
+      bool first = nextFrame == 0;
+      dt = first ? scheduler->DeltaTime() : float(scheduler->Time() - lastTime);
+      if (!first)
+      {
+        scheduler->RecordUpdate(tier, frame - lastFrame);
+      }
+      lastFrame = frame;
+      lastTime = scheduler->Time();
+
+      // After the first update, wait a staggered part of the interval.
+      tier = scheduler->TierOf(owner, FixedTier);
+      uint32_t interval = scheduler->Tiers()[tier].Interval;
+      nextFrame = frame + (first ? 1 + scheduler->NextStagger() % interval : interval);
+      return true;
+    }
+  };
+} // namespace lite